@@ -12,7 +12,10 @@ struct Options
 
 	int timeout = 0;       /**< Timeout, in seconds, before aborting solving for a problem. */
 
-	int threads = 0;       /**< Number of threads used for batch solving. */
+	int threads = 0;       /**< Number of threads used for batch solving, or to analyze a single problem. */
+
+	bool hugePages = false;    /**< If set, back search tables with huge pages when available. */
+	bool verify = false;       /**< If set, verify search cache hits against whole positions. */
 };
 
 /* -------------------------------------------------------------------------- */
@@ -29,6 +32,9 @@ bool solve(Console& console, const ForsytheString& problem, const Options& optio
 
 	EUCLIDE_Configuration configuration = {};
 	configuration.maxSolutions = 8;
+	configuration.numThreads = background ? 1 : (options.threads ? options.threads : std::thread::hardware_concurrency());
+	configuration.hugePages = options.hugePages;
+	configuration.verifyPositions = options.verify;
 
 	const EUCLIDE_Status status = EUCLIDE_solve(&configuration, problem, console);
 
@@ -258,6 +264,16 @@ int euclide(int numArguments, char *arguments[], char * /*environment*/[])
 			options.wait = true;
 		}
 		else
+		if (strcmp(arguments[argument], "--huge-pages") == 0)
+		{
+			options.hugePages = true;
+		}
+		else
+		if (strcmp(arguments[argument], "--verify") == 0)
+		{
+			options.verify = true;
+		}
+		else
 		{
 			error = Strings::InvalidArguments;
 		}
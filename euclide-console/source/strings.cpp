@@ -73,7 +73,9 @@ static const wchar_t *frenchStatuses[] =
 static const wchar_t *frenchMessages[] =
 {
 	L"Analyse pr\xE9liminaire...",
-	L"Recherche de solutions..."
+	L"Recherche de solutions...",
+	L"Recherche de solutions, en pages larges...",
+	L"Recherche de solutions, pages larges indisponibles..."
 };
 
 static_assert(countof(frenchTexts) == Strings::NumTexts);
@@ -137,7 +139,9 @@ static const wchar_t *englishStatuses[] =
 static const wchar_t *englishMessages[] =
 {
 	L"Static analysis...",
-	L"Searching solutions..."
+	L"Searching solutions...",
+	L"Searching solutions, using huge pages...",
+	L"Searching solutions, huge pages unavailable..."
 };
 
 static_assert(countof(englishTexts) == Strings::NumTexts);
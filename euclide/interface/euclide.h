@@ -147,6 +147,8 @@ typedef enum
 {
 	EUCLIDE_MESSAGE_ANALYZING,                   /**< Analyzing problem. */
 	EUCLIDE_MESSAGE_SEARCHING,                   /**< Searching for solutions. */
+	EUCLIDE_MESSAGE_SEARCHING_HUGE_PAGES,        /**< Searching for solutions, with search tables on huge pages as requested. */
+	EUCLIDE_MESSAGE_SEARCHING_NORMAL_PAGES,      /**< Searching for solutions, huge pages were requested but could not be obtained. */
 
 	EUCLIDE_NUM_MESSAGES                         /**< Number of different enumerated values. */
 
@@ -271,6 +273,9 @@ typedef struct
 typedef struct
 {
 	int maxSolutions;                     /**< Solving stops (returns OK) when reaching this number of solutions. Zero means unlimited searching. */
+	int numThreads;                       /**< Number of threads used to analyze the problem. Zero or one means the calling thread only. */
+	bool hugePages;                       /**< Back large search tables with huge pages, when the system provides them. */
+	bool verifyPositions;                 /**< Keep whole positions in the search cache, ruling out signature collisions at the cost of caching four times fewer positions. */
 
 } EUCLIDE_Configuration;
 
@@ -35,8 +35,8 @@ void Consequence::updateRequiredMoves(const array<int, NumSquares>& requiredMove
 /* -- Consequences                                                         -- */
 /* -------------------------------------------------------------------------- */
 
-Consequences::Consequences(const Action& action)
-	: m_action(action)
+Consequences::Consequences(const Action& action, Arena& arena)
+	: m_action(action), m_consequences(ArenaAllocator<Consequence>(arena))
 {
 	m_matrix.fill(nullptr);
 }
@@ -77,8 +77,8 @@ Consequence *Consequences::consequence(const Piece& piece)
 /* -- Action                                                               -- */
 /* -------------------------------------------------------------------------- */
 
-Action::Action(const Piece& piece, Square from, Square to)
-	: m_piece(piece), m_from(from), m_to(to), m_consequences(*this)
+Action::Action(const Piece& piece, Square from, Square to, Arena& arena)
+	: m_piece(piece), m_from(from), m_to(to), m_consequences(*this, arena)
 {
 	m_mandatory = false;
 	m_unique = false;
@@ -104,16 +104,42 @@ void Action::unique(bool unique)
 /* -- Actions                                                              -- */
 /* -------------------------------------------------------------------------- */
 
-Actions::Actions(const Piece& piece)
-	: m_piece(piece)
+Actions::Actions(const Piece& piece, Arena& arena)
+	: std::list<Action, ArenaAllocator<Action>>(ArenaAllocator<Action>(arena)), m_piece(piece), m_impacts(ArenaAllocator<Impact>(arena))
 {
 	for (Square from : ValidSquares(piece.stops()))
 		for (Square to : ValidSquares(piece.moves(from, false)))
-			emplace_back(piece, from, to);
+			emplace_back(piece, from, to, arena);
 
 	m_actions.fill(nullptr);
 	for (Action& action : *this)
 		m_actions[action.from()][action.to()] = &action;
+
+	m_offsets.fill(0);
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Actions::compile()
+{
+	/* -- Lay out the consequences of all actions in a single array, move after move -- */
+
+	m_impacts.clear();
+	m_impacts.reserve(xstd::sum(*this, [](const Action& action) { return int(action.consequences().consequences().size()); }));
+
+	for (Square from : AllSquares())
+	{
+		for (Square to : AllSquares())
+		{
+			m_offsets[from * NumSquares + to] = m_impacts.size();
+
+			if (const Action *action = m_actions[from][to])
+				for (const Consequence& consequence : action->consequences().consequences())
+					m_impacts.push_back({ &consequence.piece(), consequence.requiredMoves() });
+		}
+	}
+
+	m_offsets[NumSquares * NumSquares] = m_impacts.size();
 }
 
 /* -------------------------------------------------------------------------- */
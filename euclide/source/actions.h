@@ -31,6 +31,8 @@ class Consequence
 
 		inline int requiredMoves(Square square) const
 			{ return m_requiredMoves[square]; }
+		inline const array<short, NumSquares>& requiredMoves() const
+			{ return m_requiredMoves; }
 
 	private:
 		const Action& m_action;                      /**< Action having consequences. */
@@ -46,13 +48,16 @@ class Consequence
 class Consequences
 {
 	public:
-		Consequences(const Action& action);
+		typedef std::list<Consequence, ArenaAllocator<Consequence>> List;
+
+	public:
+		Consequences(const Action& action, Arena& arena);
 
 		void updateRequiredMoves(const Piece& piece, Square square, int requiredMoves);
 		void updateRequiredMoves(const Piece& piece, const array<int, NumSquares>& requiredMoves);
 
 	public:
-		inline const std::list<Consequence>& consequences() const
+		inline const List& consequences() const
 			{ return m_consequences; }
 
 	protected:
@@ -61,7 +66,7 @@ class Consequences
 	private:
 		const Action& m_action;                                  /**< Action having consequences. */
 
-		std::list<Consequence> m_consequences;                   /** List of consequences. */
+		List m_consequences;                                     /** List of consequences. */
 		matrix<Consequence *, MaxPieces, NumColors> m_matrix;    /**< Index for fast access in above list. */
 };
 
@@ -72,7 +77,7 @@ class Consequences
 class Action
 {
 	public:
-		Action(const Piece& piece, Square from, Square to);
+		Action(const Piece& piece, Square from, Square to, Arena& arena);
 
 		void mandatory(bool mandatory);
 		void unique(bool unique);
@@ -105,16 +110,46 @@ class Action
 		Consequences m_consequences;    /**< Consequences of this action. */
 };
 
+/* -------------------------------------------------------------------------- */
+/* -- Impact                                                               -- */
+/* -------------------------------------------------------------------------- */
+
+struct Impact
+{
+	const Piece *piece;                         /**< Piece facing the consequence. */
+	array<short, NumSquares> requiredMoves;     /**< Required moves for above piece given the piece position if action is performed. */
+};
+
+/* -------------------------------------------------------------------------- */
+/* -- Impacts                                                              -- */
+/* -------------------------------------------------------------------------- */
+
+class Impacts
+{
+	public:
+		Impacts(const Impact *first, const Impact *last) : m_first(first), m_last(last) {}
+
+		inline const Impact *begin() const
+			{ return m_first; }
+		inline const Impact *end() const
+			{ return m_last; }
+
+	private:
+		const Impact *m_first;    /**< First impact. */
+		const Impact *m_last;     /**< Past the last impact. */
+};
+
 /* -------------------------------------------------------------------------- */
 /* -- Actions                                                              -- */
 /* -------------------------------------------------------------------------- */
 
-class Actions : public std::list<Action>
+class Actions : public std::list<Action, ArenaAllocator<Action>>
 {
 	public:
-		Actions(const Piece& piece);
+		Actions(const Piece& piece, Arena& arena);
 
 		void clean();
+		void compile();
 
 	public:
 		const Action& get(Square from, Square to) const
@@ -122,10 +157,16 @@ class Actions : public std::list<Action>
 		Action& get(Square from, Square to)
 			{ return *m_actions[from][to]; }
 
+		inline Impacts impacts(Square from, Square to) const
+			{ const int move = from * NumSquares + to; return Impacts(m_impacts.data() + m_offsets[move], m_impacts.data() + m_offsets[move + 1]); }
+
 	private:
-		const Piece& m_piece;                                  /**< Piece performing the action. */
+		const Piece& m_piece;                                      /**< Piece performing the action. */
+
+		matrix<Action *, NumSquares, NumSquares> m_actions;        /**< Index for fast access in list. */
 
-		matrix<Action *, NumSquares, NumSquares> m_actions;    /**< Index for fast access in list. */
+		std::vector<Impact, ArenaAllocator<Impact>> m_impacts;     /**< Consequences of all actions, stored contiguously move after move. */
+		array<uint32_t, NumSquares * NumSquares + 1> m_offsets;    /**< Index in above array of the first consequence of each move. */
 };
 
 /* -------------------------------------------------------------------------- */
@@ -72,102 +72,81 @@ bool TwoPieceFastCache::hit(const Position& position) const
 
 
 /* -------------------------------------------------------------------------- */
-/* -- TwoPieceFullCache                                                    -- */
+/* -- PieceLayers                                                         -- */
 /* -------------------------------------------------------------------------- */
 
-template<typename State>
-TwoPieceFullCache<State>::TwoPieceFullCache()
+template <typename Positions, int NumPieces>
+PieceLayers<Positions, NumPieces>::PieceLayers(const array<int, NumPieces>& maximumMoves)
+	: m_maximumMoves(maximumMoves), m_size(0)
 {
-#if 1
-	const Entry entry = { false, Infinity, Infinity, Infinity, State(), State() };
-	const Line line = { entry, entry, entry, entry, entry, entry, entry, entry };
-	m_cache.fill(line);
-#else
-	for (Square squareA : AllSquares())
-		for (Square squareB : AllSquares())
-			for (Entry& entry : m_cache[squareA][squareB])
-				entry.valid = false;
-#endif
-
-	m_id = 0;
+	size_t layers = 1;
+	for (int moves : m_maximumMoves)
+		layers *= std::max(moves, 0) + 1;
+
+	m_layers.resize(layers);
 }
 
 /* -------------------------------------------------------------------------- */
 
-template<typename State>
-void TwoPieceFullCache<State>::add(Square squareA, int movesA, State stateA, Square squareB, int movesB, State stateB, int requiredMoves)
+template <typename Positions, int NumPieces>
+size_t PieceLayers<Positions, NumPieces>::index(const array<int, NumPieces>& moves) const
 {
-	Line& line = m_cache[squareA][squareB];
-
-	/* -- This is our new cache entry -- */
-
-	const Entry entry = { true, short(movesA), short(movesB), short(requiredMoves), stateA, stateB };
-
-	/* -- Find insertion point -- */
-
-	for (Entry& cache : line)
-	{
-		/* -- Already present in cache -- */
-
-		const bool hit = cache.valid && (stateA == cache.stateA) && (stateB == cache.stateB) && (movesA >= cache.movesA) && (movesB >= cache.movesB);
-		if (hit)
-			return;
-
-		/* -- Better entry -- */
-
-		const bool best = cache.valid && (stateA == cache.stateA) && (stateB == cache.stateB) && (movesA <= cache.movesA) && (movesB <= cache.movesB);
-		if (best || !cache.valid)
-			return void(cache = entry);
-	}
+	size_t index = 0;
+	for (int k = 0; k < NumPieces; k++)
+		index = index * (m_maximumMoves[k] + 1) + moves[k];
 
-	/* -- No space left for this cache line -- */
-
-	line[m_id++ % line.size()] = entry;
+	return index;
 }
 
 /* -------------------------------------------------------------------------- */
 
-template<typename State>
-bool TwoPieceFullCache<State>::hit(Square squareA, int movesA, State stateA, Square squareB, int movesB, State stateB, int *requiredMoves) const
+template <typename Positions, int NumPieces>
+std::vector<typename PieceLayers<Positions, NumPieces>::Layer>& PieceLayers<Positions, NumPieces>::layers(const array<int, NumPieces>& moves)
 {
-	const Line& line = m_cache[squareA][squareB];
+	return m_layers[index(moves)];
+}
 
-	/* -- Check if we have already reached this configuration in less or equal moves -- */
+/* -------------------------------------------------------------------------- */
 
-	for (const Entry& cache : line)
-	{
-		if (!cache.valid)
-			break;
+template <typename Positions, int NumPieces>
+Positions& PieceLayers<Positions, NumPieces>::squares(const array<int, NumPieces>& moves, const array<Stage, NumPieces>& stages)
+{
+	std::vector<Layer>& layers = this->layers(moves);
 
-		if ((stateA == cache.stateA) && (stateB == cache.stateB))
-			if ((movesA >= cache.movesA) && (movesB >= cache.movesB))
-				return xstd::minimize(*requiredMoves, cache.requiredMoves + (movesA - cache.movesA) + (movesB - cache.movesB)), true;
-	}
+	/* -- Layers are few, as there are seldom more than one or two squares to visit -- */
 
-	/* -- Cache miss -- */
+	for (Layer& layer : layers)
+		if (layer.stages == stages)
+			return layer.squares;
 
-	return false;
+	m_size += 1;
+	layers.emplace_back(stages);
+	return layers.back().squares;
 }
 
 /* -------------------------------------------------------------------------- */
 
-template<typename State>
-void TwoPieceFullCache<State>::add(const Position& position, int requiredMoves)
+template <typename Positions, int NumPieces>
+const Positions *PieceLayers<Positions, NumPieces>::find(const array<int, NumPieces>& moves, const array<Stage, NumPieces>& stages) const
 {
-	add(position.squares[0], position.moves[0], position.states[0], position.squares[1], position.moves[1], position.states[1], requiredMoves);
+	for (const Layer& layer : m_layers[index(moves)])
+		if (layer.stages == stages)
+			return &layer.squares;
+
+	return nullptr;
 }
 
 /* -------------------------------------------------------------------------- */
 
-template<typename State>
-bool TwoPieceFullCache<State>::hit(const Position& position, int *requiredMoves) const
-{
-	return hit(position.squares[0], position.moves[0], position.states[0], position.squares[1], position.moves[1], position.states[1], requiredMoves);
-}
+template class PieceLayers<ArrayOfSquares, 2>;
+template class PieceLayers<MatrixOfSquares, 3>;
 
+/* -------------------------------------------------------------------------- */
+/* -- SharedDistancesCache                                                -- */
 /* -------------------------------------------------------------------------- */
 
-template class TwoPieceFullCache<Squares>;
+thread_local std::map<SharedDistancesCache::Key, SharedDistancesCache::Distances> SharedDistancesCache::s_entries;
+thread_local SharedDistancesCache::Distances SharedDistancesCache::s_distances;
 
 /* -------------------------------------------------------------------------- */
 
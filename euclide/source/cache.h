@@ -38,41 +38,171 @@ class TwoPieceFastCache
 
 /* -------------------------------------------------------------------------- */
 
-template<typename State>
-class TwoPieceFullCache
+struct Stage
+{
+	Squares visits;    /**< Squares visited so far. */
+	bool promoted;     /**< Set once the pawn has been promoted. */
+	bool captured;     /**< Set once the piece has been captured. */
+
+	Stage() : visits(), promoted(false), captured(false) {}
+
+	inline bool operator==(const Stage& stage) const
+		{ return (visits == stage.visits) && (promoted == stage.promoted) && (captured == stage.captured); }
+};
+
+/* -------------------------------------------------------------------------- */
+
+template <typename Positions, int NumPieces>
+class PieceLayers
 {
 	public:
-		struct Position
+		struct Layer
 		{
-			array<Square, 2> squares;    /**< Squares on which the two pieces lie. */
-			array<int, 2> moves;         /**< Number of moves played by each piece. */
-			array<State, 2> states;      /**< States of each piece. */
+			array<Stage, NumPieces> stages;    /**< Stage of each piece. */
+			Positions squares;                 /**< Squares occupied by the last piece, for each squares of the other pieces. */
 
-			Position() = default;
-			Position(Square squareA, int movesA, State stateA, Square squareB, int movesB, State stateB)
-				{ squares = { squareA, squareB }; moves = { movesA, movesB }; states = { stateA, stateB }; }
+			Layer(const array<Stage, NumPieces>& stages) : stages(stages), squares() {}
 		};
 
 	public:
-		TwoPieceFullCache();
+		PieceLayers(const array<int, NumPieces>& maximumMoves);
 
-		void add(Square squareA, int movesA, State stateA, Square squareB, int movesB, State stateB, int requiredMoves);
-		bool hit(Square squareA, int movesA, State stateA, Square squareB, int movesB, State stateB, int *requiredMoves) const;
+		std::vector<Layer>& layers(const array<int, NumPieces>& moves);
+		Positions& squares(const array<int, NumPieces>& moves, const array<Stage, NumPieces>& stages);
+		const Positions *find(const array<int, NumPieces>& moves, const array<Stage, NumPieces>& stages) const;
 
-		void add(const Position& position, int requiredMoves);
-		bool hit(const Position& position, int *requiredMoves) const;
+		inline size_t size() const
+			{ return m_size; }
+
+	protected:
+		size_t index(const array<int, NumPieces>& moves) const;
 
 	private:
-		typedef struct { bool valid; short movesA, movesB; short requiredMoves; State stateA, stateB; } Entry;
-		typedef array<Entry, 8> Line;                    /**< A cache line is made of up to eight elements. */
-		matrix<Line, NumSquares, NumSquares> m_cache;    /**< Cache, one line for each pair of squares. */
+		array<int, NumPieces> m_maximumMoves;        /**< Maximum number of moves for each piece. */
+		std::vector<std::vector<Layer>> m_layers;    /**< Layers, indexed by the number of moves played by each piece. */
+		size_t m_size;                               /**< Number of layers created so far. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+class TwoPieceLayers : public PieceLayers<ArrayOfSquares, 2>
+{
+	public:
+		TwoPieceLayers(int maximumMovesA, int maximumMovesB) : PieceLayers({ maximumMovesA, maximumMovesB }) {}
+};
+
+/* -------------------------------------------------------------------------- */
 
-		unsigned m_id;                                   /**< Id used as pseudo-random number to replace cache entries where there is no space left. */
+class ThreePieceLayers : public PieceLayers<MatrixOfSquares, 3>
+{
+	public:
+		ThreePieceLayers(int maximumMovesA, int maximumMovesB, int maximumMovesC) : PieceLayers({ maximumMovesA, maximumMovesB, maximumMovesC }) {}
 };
 
 /* -------------------------------------------------------------------------- */
 
-class TwoPieceCache : public TwoPieceFullCache<Squares> {};
+class DistancesCache
+{
+	public:
+		typedef array<int, NumSquares> Distances;
+
+		struct Key
+		{
+			const void *piece;                /**< Piece whose distances are computed. */
+			Square obstruction;               /**< Obstructed square, or Nowhere if there is none. */
+			const ArrayOfSquares *checks;     /**< Checks of the blocker, if they matter. */
+			bool enemies;                     /**< Set if the blocker is an enemy. */
+			bool royal;                       /**< Set if the blocker is an enemy king. */
+
+			inline bool operator<(const Key& key) const
+				{ return std::tie(piece, obstruction, checks, enemies, royal) < std::tie(key.piece, key.obstruction, key.checks, key.enemies, key.royal); }
+		};
+
+	public:
+		template <typename Function>
+		const Distances& distances(const Key& key, unsigned version, const Function& compute);
+
+		inline void clear()
+			{ m_entries.clear(); }
+
+	private:
+		struct Entry { unsigned version; Distances distances; };
+		std::map<Key, Entry> m_entries;       /**< Cached distances, with the piece version they were computed for. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+template <typename Function>
+const DistancesCache::Distances& DistancesCache::distances(const Key& key, unsigned version, const Function& compute)
+{
+	auto result = m_entries.emplace(key, Entry());
+	Entry& entry = result.first->second;
+
+	if (result.second || (entry.version != version))
+	{
+		entry.version = version;
+		entry.distances = compute();
+	}
+
+	return entry.distances;
+}
+
+/* -------------------------------------------------------------------------- */
+
+class SharedDistancesCache
+{
+	public:
+		typedef array<int, NumSquares> Distances;
+
+		template <typename Function>
+		static const Distances& distances(const ArrayOfSquares *table, const ArrayOfSquares& moves, Squares sources, const Function& compute)
+			{ return get(table, moves, nullptr, sources, compute); }
+		template <typename Function>
+		static const Distances& captures(const ArrayOfSquares *table, const ArrayOfSquares& moves, const ArrayOfSquares *xmoves, Squares sources, const Function& compute)
+			{ return get(table, moves, xmoves, sources, compute); }
+
+	protected:
+		struct Key
+		{
+			const ArrayOfSquares *moves;     /**< Shared legal moves table. */
+			const ArrayOfSquares *xmoves;    /**< Shared table of moves that must be captures, or null when computing distances. */
+			uint64_t sources;                /**< Starting squares. */
+
+			inline bool operator<(const Key& key) const
+				{ return std::tie(moves, xmoves, sources) < std::tie(key.moves, key.xmoves, key.sources); }
+		};
+
+		template <typename Function>
+		static const Distances& get(const ArrayOfSquares *table, const ArrayOfSquares& moves, const ArrayOfSquares *xmoves, Squares sources, const Function& compute);
+
+	private:
+		static const size_t MaxEntries = 4096;                     /**< The cache is flushed when growing past this size. */
+
+		static thread_local std::map<Key, Distances> s_entries;    /**< Cached distances, shared by all pieces and problems solved on the same thread. */
+		static thread_local Distances s_distances;                 /**< Distances of moves that are not cached. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+template <typename Function>
+const SharedDistancesCache::Distances& SharedDistancesCache::get(const ArrayOfSquares *table, const ArrayOfSquares& moves, const ArrayOfSquares *xmoves, Squares sources, const Function& compute)
+{
+	/* -- Moves narrowed down by the analysis belong to a single piece, only moves still matching shared tables are worth caching -- */
+
+	if (moves != *table)
+		return s_distances = compute();
+
+	if (s_entries.size() >= MaxEntries)
+		s_entries.clear();
+
+	/* -- Returned distances remain valid until the next lookup from the same thread -- */
+
+	auto result = s_entries.emplace(Key{ table, xmoves, uint64_t(sources) }, Distances());
+	if (result.second)
+		result.first->second = compute();
+
+	return result.first->second;
+}
 
 /* -------------------------------------------------------------------------- */
 
@@ -28,8 +28,6 @@ class Capture
 		bool updatePossibleSquares(Squares squares);
 		bool updatePossibleMen(Men men, Men xmen);
 
-		bool applyPigeonHolePrinciple(Targets& targets, Captures& captures) const;
-
 	public:
 		bool operator==(const Capture& capture) const
 			{ return (capture.m_glyphs == m_glyphs) && (capture.m_squares == m_squares) && (capture.m_men == m_men) && (capture.m_xmen == m_xmen); }
@@ -88,8 +86,6 @@ class Capture
 
 class Captures : public std::vector<Capture>
 {
-	public:
-		bool update(Targets& targets);
 };
 
 /* -------------------------------------------------------------------------- */
@@ -1,10 +1,13 @@
 #include "includes.h"
 #include "partitions.h"
+#include "pawns.h"
 #include "captures.h"
 #include "problem.h"
 #include "targets.h"
 #include "pieces.h"
 #include "game.h"
+#include "cache.h"
+#include "utilities/threads.h"
 
 namespace Euclide
 {
@@ -31,8 +34,11 @@ class Euclide
 	private:
 		EUCLIDE_Configuration m_configuration;      /**< Global configuration. */
 		EUCLIDE_Callbacks m_callbacks;              /**< User defined callbacks. */
+		ThreadPool m_threads;                       /**< Threads used to update deductions. */
 
 		Problem m_problem;                          /**< Current problem to solve. */
+		Arena m_arena;                              /**< Memory used by deductions, released at once when solving next problem. */
+		Arena m_scratch;                            /**< Memory used by partitions, released at once when they are rebuilt. */
 
 		array<Pieces, NumColors> m_pieces;          /**< Deductions on pieces. */
 		array<Targets, NumColors> m_targets;        /**< Targets that must be fullfilled. */
@@ -42,7 +48,10 @@ class Euclide
 		array<int, NumColors> m_freeCaptures;       /**< Unassigned captures. */
 
 		struct Tandem { const Piece& pieceA; const Piece& pieceB; int requiredMoves; Tandem(const Piece& pieceA, const Piece& pieceB, int requiredMoves) : pieceA(pieceA), pieceB(pieceB), requiredMoves(requiredMoves) {}};
-		std::vector<Tandem> m_tandems;              /**< Required moves for pair of pieces. */
+		typedef std::vector<Tandem, ArenaAllocator<Tandem>> Tandems;
+		Tandems m_tandems;                          /**< Required moves for pair of pieces. */
+
+		DistancesCache m_distances;                 /**< Distances of pieces around obstructions, shared by all pieces. */
 
 	private:
 		mutable EUCLIDE_Deductions m_deductions;    /**< Temporary variable to hold deductions for corresponding user callback. */
@@ -51,7 +60,7 @@ class Euclide
 /* -------------------------------------------------------------------------- */
 
 Euclide::Euclide(const EUCLIDE_Configuration& configuration, const EUCLIDE_Callbacks& callbacks)
-	: m_configuration(configuration), m_callbacks(callbacks)
+	: m_configuration(configuration), m_callbacks(callbacks), m_threads(configuration.numThreads), m_pieces({{ Pieces(m_arena), Pieces(m_arena) }}), m_tandems(ArenaAllocator<Tandem>(m_arena))
 {
 	/* -- Display copyright string -- */
 
@@ -71,12 +80,17 @@ void Euclide::reset()
 {
 	for (Color color : AllColors())
 	{
-		m_pieces[color].clear();
+		m_pieces[color] = Pieces(m_arena);
 		m_targets[color].clear();
 		m_captures[color].clear();
 	}
 
-	m_tandems.clear();
+	m_tandems = Tandems(ArenaAllocator<Tandem>(m_arena));
+	m_distances.clear();
+
+	/* -- Containers above no longer hold any arena memory, which may be recycled -- */
+
+	m_arena.reset();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -106,7 +120,7 @@ void Euclide::solve(const EUCLIDE_Problem& problem)
 	for (Glyph glyph : MostGlyphs())
 		for (Square square : AllSquares())
 			if (m_problem.initialPosition(square) == glyph)
-				m_pieces[color(glyph)].emplace_back(m_problem, square, m_pieces[color(glyph)].size());
+				m_pieces[color(glyph)].emplace_back(m_problem, square, m_pieces[color(glyph)].size(), m_arena);
 
 	/* -- Initialize targets and captures -- */
 
@@ -133,6 +147,10 @@ void Euclide::solve(const EUCLIDE_Problem& problem)
 		for (Piece& piece : m_pieces[color])
 			pieces.push_back(&piece);
 
+	/* -- Tandems are rebuilt on each pass, make room once for all pairs of pieces and as many from triangulations -- */
+
+	m_tandems.reserve(pieces.size() * (pieces.size() - 1));
+
 	/* -- Castling pieces -- */
 
 	typedef struct { Piece *king, *rook; } CastlingPieces;
@@ -230,11 +248,12 @@ void Euclide::solve(const EUCLIDE_Problem& problem)
 							xpieces[xman].setVisitedSquares(squares);
 					}
 
-				} while (targets.update(captures) || captures.update(targets));
+				} while (targets.update(captures));
 
-				/* -- Merge targets into partitions -- */
+				/* -- Merge targets into partitions, recycling memory of previous ones -- */
 
-				Partitions partitions(pieces, m_targets[color], m_captures[color]);
+				m_scratch.reset();
+				Partitions partitions(pieces, m_targets[color], m_captures[color], m_scratch);
 
 				/* -- Update possible glyphs and squares -- */
 
@@ -301,6 +320,12 @@ void Euclide::solve(const EUCLIDE_Problem& problem)
 				for (const Partition& partition : partitions)
 					if (partition.map(pieces, m_captures[!color]))
 						analyse = true;
+
+				/* -- Restrict pawns to consistent pawn structures -- */
+
+				const PawnStructure structure(pieces, targets, color, m_problem.moves(color), m_problem.capturedPieces(!color));
+				if (structure.update(pieces, targets))
+					analyse = true;
 			}
 		}
 
@@ -369,6 +394,25 @@ void Euclide::solve(const EUCLIDE_Problem& problem)
 
 		/* -- Update pieces -- */
 
+		if (update(pieces))
+			continue;
+
+		/* -- Mutual obstructions between three pieces, only for those that pairwise interact -- */
+
+		matrix<bool, 2 * MaxPieces, 2 * MaxPieces> interactions(false);
+		for (unsigned pieceA = 0; pieceA < pieces.size(); pieceA++)
+			for (unsigned pieceB = pieceA + 1; pieceB < pieces.size(); pieceB++)
+				interactions[pieceA][pieceB] = Piece::interacts(*pieces[pieceA], *pieces[pieceB]);
+
+		for (unsigned pieceA = 0; pieceA < pieces.size(); pieceA++)
+			for (unsigned pieceB = pieceA + 1; pieceB < pieces.size(); pieceB++)
+				if (interactions[pieceA][pieceB])
+					for (unsigned pieceC = pieceB + 1; pieceC < pieces.size(); pieceC++)
+						if (interactions[pieceA][pieceC] && interactions[pieceB][pieceC])
+							Piece::mutualInteractions(*pieces[pieceA], *pieces[pieceB], *pieces[pieceC], m_freeMoves);
+
+		/* -- Update pieces -- */
+
 		if (update(pieces))
 			continue;
 
@@ -391,7 +435,11 @@ void Euclide::solve(const EUCLIDE_Problem& problem)
 
 			for (Color color : AllColors())
 				for (Piece& piece : m_pieces[color])
-					piece.findConsequences(m_pieces);
+					piece.findConsequences(m_pieces, m_distances);
+
+			for (Color color : AllColors())
+				for (Piece& piece : m_pieces[color])
+					piece.compileConsequences();
 
 			consequences = true;
 			//continue;
@@ -407,14 +455,15 @@ void Euclide::solve(const EUCLIDE_Problem& problem)
 	if (m_callbacks.displayDeductions)
 		(*m_callbacks.displayDeductions)(m_callbacks.handle, &deductions());
 
-	/* -- Display playing message -- */
+	/* -- Create game, then display playing message, telling whether requested huge pages were obtained -- */
+
+	std::unique_ptr<Game> game(new Game(m_configuration, m_callbacks, m_problem, m_pieces, m_freeMoves));
 
 	if (m_callbacks.displayMessage)
-		(*m_callbacks.displayMessage)(m_callbacks.handle, EUCLIDE_MESSAGE_SEARCHING);
+		(*m_callbacks.displayMessage)(m_callbacks.handle, !m_configuration.hugePages ? EUCLIDE_MESSAGE_SEARCHING : game->hugePages() ? EUCLIDE_MESSAGE_SEARCHING_HUGE_PAGES : EUCLIDE_MESSAGE_SEARCHING_NORMAL_PAGES);
 
 	/* -- Play all possible games -- */
 
-	std::unique_ptr<Game> game(new Game(m_configuration, m_callbacks, m_problem, m_pieces, m_freeMoves));
 	game->play();
 }
 
@@ -422,11 +471,30 @@ void Euclide::solve(const EUCLIDE_Problem& problem)
 
 bool Euclide::update(std::vector<Piece *>& pieces)
 {
+	/* -- Update personalities, then pieces, concurrently as each one only writes its own deductions -- */
+
+	std::vector<Piece *> personalities;
+	for (Piece *piece : pieces)
+		for (Piece& personality : piece->personalities())
+			personalities.push_back(&personality);
+
+	m_threads.run(personalities.size(), [&](int personality) { personalities[personality]->update(); });
+
+	array<bool, 2 * MaxPieces> updates;
+	m_threads.run(pieces.size(), [&](int piece) { updates[piece] = pieces[piece]->update(); });
+
+	/* -- Occupied squares depend on other pieces and are updated in order -- */
+
 	unsigned updated = 0;
 
 	for (unsigned piece = 0; piece < pieces.size(); piece++)
-		if (pieces[piece]->update())
+	{
+		if (updates[piece])
+		{
+			pieces[piece]->updateOccupiedSquares();
 			std::swap(pieces[piece], pieces[updated++]);
+		}
+	}
 
 	return updated > 0;
 }
@@ -439,129 +507,126 @@ bool Euclide::triangulation()
 
 	for (Color color : AllColors())
 	{
-		const Pieces& pieces = m_pieces[color];
+		Pieces& pieces = m_pieces[color];
 
-		/* -- Triangulation requires an odd number of free moves -- */
-
-		const int freeMoves = m_freeMoves[color];
-		if ((freeMoves < 3) || (freeMoves % 2 == 0))
-			continue;
+		const int moves = m_problem.moves(color);
+		const int parity = moves % 2;
 
-		/* -- Find pieces that may perform a triangulation (easy way, should be improved later) -- */
+		/* -- Fewest even and odd number of moves each piece may play to reach its final square -- */
 
-		Men candidates([&](Man man) -> bool {
-			if (size_t(man) >= pieces.size())
-				return false;
+		array<array<int, 2>, MaxPieces> parities;
+		for (const Piece& piece : pieces)
+			parities[piece.man()] = piece.requiredMovesByParity();
 
-			if (pieces[man].nmoves() <= 2)
-				return false;
+		/* -- Fewest even and odd total number of moves, over all pieces but one -- */
 
-			if (pieces[man].species() == Knight)
-				if (!maybe(pieces[man].captured()) && !maybe(pieces[man].promoted()))
-					return false;
+		auto combine = [&](Man excluded) -> array<int, 2> {
+			array<int, 2> total = {{ 0, Infinity }};
 
-			return true;
-			});
+			for (const Piece& piece : pieces)
+			{
+				if (piece.man() == excluded)
+					continue;
 
-		if (!candidates)
-			throw NoSolution;
+				const array<int, 2>& required = parities[piece.man()];
+				const array<int, 2> next = {{
+					std::min(std::min(total[0] + required[0], total[1] + required[1]), int(Infinity)),
+					std::min(std::min(total[0] + required[1], total[1] + required[0]), int(Infinity))
+				}};
 
-		/* -- Handle only simple triangulation cases -- */
+				total = next;
+			}
 
-		if (candidates.count() > 2)
-			continue;
+			return total;
+		};
 
-		if (xstd::any_of(candidates.range(), [&](Man man) -> bool { return maybe(pieces[man].captured()) || maybe(pieces[man].promoted()); }))
-			continue;
+		if (combine(MaxPieces)[parity] > moves)
+			throw NoSolution;
 
-		/* -- Find squares and cost of triangulation for each piece -- */
+		/* -- Discard parities that no longer fit, and find pieces left free to lose a tempo -- */
 
-		int triangulationMoves = Infinity;
+		Men candidates;
+		int cheapestMoves = 0;
+		int tempoMoves = Infinity;
 
-		for (Man man : ValidMen(candidates))
+		for (Piece& piece : pieces)
 		{
-			const Piece& piece = pieces[man];
-			bool possible = false;
+			const array<int, 2>& required = parities[piece.man()];
+			const array<int, 2> others = combine(piece.man());
 
-			for (Square square : ValidSquares(piece.stops()))
-			{
-				for (Square trip : ValidSquares(piece.moves(square, false)))
-				{
-					const int requiredMovesTo = piece.requiredMovesTo(square);
-					const int requiredMovesFrom = piece.requiredMovesFrom(trip);
-					const int requiredMoves = requiredMovesTo + 1 + requiredMovesFrom;
+			const bool even = (required[0] < Infinity) && (required[0] + others[parity] <= moves);
+			const bool odd = (required[1] < Infinity) && (required[1] + others[!parity] <= moves);
 
-					if (requiredMoves < piece.requiredMoves())
-						continue;
+			if (!even && !odd)
+				throw NoSolution;
 
-					if (((requiredMoves - piece.requiredMoves()) % 2) == 0)
-						continue;
+			if (even && odd)
+			{
+				candidates.set(piece.man());
+				cheapestMoves += std::min(required[0], required[1]);
+				xstd::minimize(tempoMoves, std::abs(required[1] - required[0]));
+				continue;
+			}
 
-					if (requiredMoves > piece.requiredMoves() + piece.availableMoves())
-						continue;
+			const int requiredMoves = required[odd ? 1 : 0];
+			cheapestMoves += requiredMoves;
 
-					xstd::minimize(triangulationMoves, requiredMoves - piece.requiredMoves());
-					possible = true;
-				}
+			if (requiredMoves > piece.requiredMoves())
+			{
+				piece.setRequiredMoves(requiredMoves);
+				updated = true;
 			}
-
-			if (!possible)
-				candidates.reset(man);
 		}
 
-		if (triangulationMoves >= Infinity)
-			continue;
+		/* -- A tempo must be lost when the cheapest parities do not add up, handle only simple cases -- */
 
-		/* -- Special case for dedicated pattern (should be replaced by generic code) -- */
+		const int freeMoves = moves - cheapestMoves;
+		if ((freeMoves % 2 == 0) || (candidates.count() != 2))
+			continue;
 
-		if (candidates.count() == 2)
-		{
-			Piece& king = m_pieces[color][candidates.first()];
-			Piece& queen = m_pieces[color][candidates.next(king.man())];
+		if (xstd::any_of(candidates.range(), [&](Man man) -> bool { return maybe(pieces[man].captured()) || maybe(pieces[man].promoted()); }))
+			continue;
 
-			const Square pivot = (color ? F7 : F2);
-			const Squares star = Squares(color ? E8 : E1) | Squares(color ? G8 : G1) | Squares(color ? E6 : E3) | Squares(color ? G6 : G3);
+		Piece& pieceA = pieces[candidates.first()];
+		Piece& pieceB = pieces[candidates.next(pieceA.man())];
 
-			bool special = false;
-			if ((king.species() == King) && (queen.species() == Queen))
-				if (!king.requiredMoves() && !queen.requiredMoves())
-					if (queen.moves(queen.initialSquare(), false) == Squares(king.initialSquare()))
-						if (king.moves(king.initialSquare(), false) <= (Squares(queen.initialSquare()) | Squares(pivot)))
-							if (king.moves(pivot, false) <= star)
-								special = true;
+		/* -- Special case for dedicated pattern, where king and queen obstruct each other -- */
 
-			if (special)
-			{
-				xstd::maximize(triangulationMoves, 7);
+		const Piece& king = pieceA;
+		const Piece& queen = pieceB;
 
-				if (freeMoves < 9)
-					candidates.reset(queen.man());
-			}
-		}
+		const Square pivot = (color ? F7 : F2);
+		const Squares star = Squares(color ? E8 : E1) | Squares(color ? G8 : G1) | Squares(color ? E6 : E3) | Squares(color ? G6 : G3);
 
-		/* -- Assign moves to pieces -- */
+		bool special = false;
+		if ((king.species() == King) && (queen.species() == Queen))
+			if (!king.requiredMoves() && !queen.requiredMoves())
+				if (queen.moves(queen.initialSquare(), false) == Squares(king.initialSquare()))
+					if (king.moves(king.initialSquare(), false) <= (Squares(queen.initialSquare()) | Squares(pivot)))
+						if (king.moves(pivot, false) <= star)
+							special = true;
 
-		if (candidates.count() == 1)
+		if (special)
 		{
-			Piece& piece = m_pieces[color][candidates.pop()];
-			piece.setRequiredMoves(piece.requiredMoves() + triangulationMoves);
+			xstd::maximize(tempoMoves, 7);
 
-			updated = true;
+			if (freeMoves < 9)
+			{
+				pieceA.setRequiredMoves(pieceA.requiredMoves() + tempoMoves);
+				updated = true;
+				continue;
+			}
 		}
-		else
-		if (candidates.count() == 2)
-		{
-			Piece& pieceA = m_pieces[color][candidates.pop()];
-			Piece& pieceB = m_pieces[color][candidates.pop()];
 
-			const int requiredMoves = pieceA.requiredMoves() + pieceB.requiredMoves() + triangulationMoves;
+		/* -- Assign tempo moves to the pair of pieces -- */
 
-			if (!xstd::any_of(m_tandems, [&](const Tandem& tandem) -> bool {
-				return (((&tandem.pieceA == &pieceA) && (&tandem.pieceB == &pieceB)) || ((&tandem.pieceA == &pieceB) && (&tandem.pieceB == &pieceA))) && (tandem.requiredMoves >= requiredMoves);
-			})) {
-				m_tandems.emplace_back(pieceA, pieceB, requiredMoves);
-				updated = true;
-			}
+		const int requiredMoves = std::min(parities[pieceA.man()][0], parities[pieceA.man()][1]) + std::min(parities[pieceB.man()][0], parities[pieceB.man()][1]) + tempoMoves;
+
+		if (!xstd::any_of(m_tandems, [&](const Tandem& tandem) -> bool {
+			return (((&tandem.pieceA == &pieceA) && (&tandem.pieceB == &pieceB)) || ((&tandem.pieceA == &pieceB) && (&tandem.pieceB == &pieceA))) && (tandem.requiredMoves >= requiredMoves);
+		})) {
+			m_tandems.emplace_back(pieceA, pieceB, requiredMoves);
+			updated = true;
 		}
 	}
 
@@ -2,7 +2,6 @@
 #include "pieces.h"
 #include "problem.h"
 #include "actions.h"
-#include "tables/tables.h"
 
 namespace Euclide
 {
@@ -12,17 +11,39 @@ namespace Euclide
 /* -------------------------------------------------------------------------- */
 
 Game::Game(const EUCLIDE_Configuration& configuration, const EUCLIDE_Callbacks& callbacks, const Problem& problem, const array<Pieces, NumColors>& pieces, const array<int, NumColors>& freeMoves)
-	: m_configuration(configuration), m_callbacks(callbacks), m_problem(problem), m_pieces(pieces), m_hash(problem), m_cache(16 * 1024 * 1024)
+	: m_configuration(configuration), m_callbacks(callbacks), m_problem(problem), m_pieces(pieces), m_orthogonals(Tables::getRookMagics()), m_diagonals(Tables::getBishopMagics()), m_hash(problem), m_cache(size_t(640) << 20, configuration.hugePages, configuration.verifyPositions)
 {
 	/* -- Initialize constant tables -- */
 
 	for (Glyph glyph : AllGlyphs())
-		Tables::initializeLegalMoves(&m_captures[glyph], problem.piece(glyph), color(glyph), problem.variant(), true, true);
+		m_captures[glyph] = Tables::getLegalMoves(problem.piece(glyph), color(glyph), problem.variant(), true, true);
+
+	for (Glyph glyph : MostGlyphs())
+		for (Square from : AllSquares())
+			for (Square king : ValidSquares((*m_captures[glyph])[from]))
+				m_checks[!color(glyph)][king].set(from);
+
+	/* -- Runners use attack tables, leapers are never blocked, hoppers look for their hurdle, other fairy pieces keep their constraints -- */
+
+	array<Species, NumGlyphs> others;
+	others.fill(None);
 
 	for (Glyph glyph : AllGlyphs())
-		m_constraints[glyph] = *Tables::getMoveConstraints(problem.piece(glyph), problem.variant(), true, false);
+	{
+		const Species species = problem.piece(glyph);
+
+		m_runners.set(glyph, (species == Queen) || (species == Rook) || (species == Bishop) || (species == Amazon) || (species == Empress) || (species == Princess));
+		m_hoppers.set(glyph, (species == Grasshopper) || (species == Leo) || (species == Pao) || (species == Vao));
+		m_constraints[glyph] = nullptr;
+
+		if ((species == Nightrider) || (species == Mao))
+			m_constraints[glyph] = Tables::getMoveConstraints(others[glyph] = species, problem.variant(), true, false);
+
+		if (m_hoppers[glyph])
+			others[glyph] = species;
+	}
 
-	Tables::initializeLineOfSights(problem.pieces(), problem.variant(), &m_lines);
+	m_lines = xstd::any_of(others, [](Species species) { return species != None; }) ? Tables::getLineOfSights(others, problem.variant()) : nullptr;
 
 	/* -- Initialize position and relevant information -- */
 
@@ -73,10 +94,14 @@ Game::~Game()
 
 void Game::play()
 {
-	/* -- Recursively play all moves from initial state -- */
+	/* -- Recursively play all moves from initial state, checks through fairy line of sights being compiled out when not needed -- */
 
 	const State state(m_problem);
-	play(state);
+
+	if (m_lines)
+		play<true>(state);
+	else
+		play<false>(state);
 
 	/* -- Done -- */
 
@@ -93,6 +118,7 @@ void Game::play()
 
 /* -------------------------------------------------------------------------- */
 
+template <bool Fairy>
 bool Game::play(const State& _state)
 {
 	m_positions += 1;
@@ -162,7 +188,15 @@ bool Game::play(const State& _state)
 		const Glyph glyph = piece.state.glyph;
 		const bool pawn = (glyph != piece.glyph());
 
-		const Squares destinations = piece.moves(from, pawn) - m_position[color];
+		Squares destinations = piece.moves(from, pawn) - m_position[color];
+		if (Fairy && m_hoppers[glyph])
+			destinations &= Tables::getHopperMoves(m_problem.piece(glyph), from, position, m_orthogonals, m_diagonals);
+
+		/* -- Whether the piece shields either king is only looked up once one of its moves gets that far -- */
+
+		tribool pinned = unknown;
+		bool discovers = false;
+
 		for (Square to : ValidSquares(destinations))
 		{
 			/* -- Check if capture is ok -- */
@@ -199,7 +233,22 @@ bool Game::play(const State& _state)
 				if (!rook || (rook->color() != color) || !maybe(rook->castling(castling)) || rook->state.moves)
 					continue;
 
-				if (_state.check() || checked(Castlings[color][castling].free, color))
+				if (_state.check() || checked<Fairy>(Castlings[color][castling].free, color))
+					continue;
+			}
+
+			/* -- Pieces shielding our king may only move along the pin line, those shielding the enemy king may discover a check -- */
+
+			if (unknown(pinned))
+			{
+				pinned = !_state.check() && !piece.royal() && exposes(m_kings[color], from, color);
+				discovers = exposes(m_kings[!color], from, !color);
+			}
+
+			if (is(pinned))
+			{
+				const Tables::Magics& magics = m_orthogonals[m_kings[color]].lines()[from] ? m_orthogonals : m_diagonals;
+				if (!(magics[m_kings[color]].lines() & magics[from].lines())[to])
 					continue;
 			}
 
@@ -211,13 +260,12 @@ bool Game::play(const State& _state)
 
 			if (!maybe(piece.promoted()))
 			{
-				const Consequences& consequences = piece.consequences(from, to);
-				for (const Consequence& consequence : consequences.consequences())
+				for (const Impact& impact : piece.consequences(from, to))
 				{
-					const Piece& impacted = consequence.piece();
+					const Piece& impacted = *impact.piece;
 					if (&impacted != &piece)
 					{
-						const int requiredMoves = consequence.requiredMoves(impacted.state.square);
+						const int requiredMoves = impact.requiredMoves[impacted.state.square];
 						const int extraMoves = requiredMoves - impacted.state.assignedMoves;
 						if (extraMoves > 0)
 							m_assignments.emplace_back(&impacted.state.assignedMoves, &m_moves[impacted.color()], extraMoves);
@@ -248,27 +296,32 @@ bool Game::play(const State& _state)
 
 				bool valid = true;
 				if (piece.royal() || _state.check())
-					valid &= !checked(m_kings[color], color);
+					valid &= !checked<Fairy>(m_kings[color], color);
 				else
-					valid &= !checked(m_kings[color], from, color);
+				if (Fairy || enpassant)
+					valid &= !checked<Fairy>(m_kings[color], from, color) && !(Fairy && hurdles(m_kings[color], to, color));
 
 				if (valid)
 				{
 					/* -- Set check state -- */
 
-					if (checks(glyph, to, m_kings[!color]))
+					if (checks<Fairy>(glyph, to, m_kings[!color]))
 						state.check(true);
 
-					if (checked(m_kings[!color], from, !color))
+					if (discovers || Fairy || enpassant)
+						if (checked<Fairy>(m_kings[!color], from, !color))
+							state.check(true);
+
+					if (Fairy && hurdles(m_kings[!color], to, !color))
 						state.check(true);
 
 					if (castling != NoCastling)
-						if (checks(m_board[Castlings[color][castling].free]->glyph(), Castlings[color][castling].free, m_kings[!color]))
+						if (checks<Fairy>(m_board[Castlings[color][castling].free]->glyph(), Castlings[color][castling].free, m_kings[!color]) || (Fairy && hurdles(m_kings[!color], Castlings[color][castling].free, !color)))
 							state.check(true);
 
 					/* -- Recursive call -- */
 
-					if (!play(state))
+					if (!play<Fairy>(state))
 					{
 						/* -- Add position to cache if it does not lead to a solution -- */
 
@@ -284,7 +337,7 @@ bool Game::play(const State& _state)
 				/* -- Undo move -- */
 
 				m_states.pop_back();
-				undo(state);
+				undo(state, _state);
 			}
 		}
 	}
@@ -383,7 +436,7 @@ Game::State Game::move(const State& state, Square from, Square to, Glyph glyph,
 
 /* -------------------------------------------------------------------------- */
 
-void Game::undo(const State& state)
+void Game::undo(const State& state, const State& previous)
 {
 	const Color color = !state.color();
 	const Square capture = state.capture();
@@ -441,40 +494,115 @@ void Game::undo(const State& state)
 		m_board[rook]->state.square = rook;
 	}
 
-	m_hash[m_kings[color]] = state.castlings(color);
+	m_hash[m_kings[color]] = previous.castlings(color);
 }
 
 /* -------------------------------------------------------------------------- */
 
+template <bool Fairy>
 bool Game::checks(Glyph glyph, Square from, Square king) const
 {
+	if (!(*m_captures[glyph])[from][king])
+		return false;
+
 	const Squares blockers = m_position[White] | m_position[Black];
 
-	if (m_captures[glyph][from][king])
-		if (!(m_constraints[glyph][from][king] & blockers))
-			return true;
+	/* -- Runners check unless blocked on their line, leaps and knight moves can not be blocked -- */
 
-	return false;
+	if (m_runners[glyph])
+	{
+		if (m_orthogonals[king].lines()[from])
+			return m_orthogonals[king](blockers)[from];
+
+		if (m_diagonals[king].lines()[from])
+			return m_diagonals[king](blockers)[from];
+
+		return true;
+	}
+
+	if (Fairy && m_hoppers[glyph])
+		return Tables::getHopperMoves(m_problem.piece(glyph), from, blockers, m_orthogonals, m_diagonals)[king];
+
+	if (Fairy && m_constraints[glyph])
+		return !((*m_constraints[glyph])[from][king] & blockers);
+
+	return true;
 }
 
 /* -------------------------------------------------------------------------- */
 
+template <bool Fairy>
 bool Game::checked(Square king, Color color) const
 {
-	return checked(king, king, color);
+	return checked<Fairy>(king, king, color);
 }
 
 /* -------------------------------------------------------------------------- */
 
+template <bool Fairy>
 bool Game::checked(Square king, Square free, Color color) const
 {
-	const Squares enemies = m_lines[color][king][free] & m_position[!color];
+	/* -- Find enemies that may check the king, or only those whose line goes through the freed square -- */
 
-	for (Square from : ValidSquares(enemies))
-		if (checks(m_board[from]->state.glyph, from, king))
-			return true;
+	Squares enemies;
+
+	if (free == king)
+		enemies = m_checks[color][king] & m_position[!color];
+	else
+	{
+		const Tables::Magic& magic = m_orthogonals[king].lines()[free] ? m_orthogonals[king] : m_diagonals[king];
+
+		if (magic.lines()[free] && (magic.lines() & m_position[!color]))
+		{
+			const Squares blockers = m_position[White] | m_position[Black];
+			enemies = (magic(blockers) - magic(blockers | Squares(free))) & m_position[!color];
+		}
+
+		if (Fairy)
+			enemies |= (*m_lines)[color][king][free] & m_position[!color];
+	}
+
+	return enemies.any([&](Square from) { return checks<Fairy>(m_board[from]->state.glyph, from, king); });
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Game::exposes(Square king, Square from, Color color) const
+{
+	/* -- Only the first piece seen from the king on one of its lines may shield it -- */
+
+	const Tables::Magic& magic = m_orthogonals[king].lines()[from] ? m_orthogonals[king] : m_diagonals[king];
+	if (!magic.lines()[from] || !(magic.lines() & m_position[!color]))
+		return false;
+
+	const Squares blockers = m_position[White] | m_position[Black];
+	const Squares visible = magic(blockers);
+	if (!visible[from])
+		return false;
+
+	/* -- Look for enemy runners right behind it -- */
+
+	const Squares enemies = (magic(blockers - Squares(from)) - visible) & m_position[!color];
+	return enemies.any([&](Square enemy) { const Glyph glyph = m_board[enemy]->state.glyph; return m_runners[glyph] && (*m_captures[glyph])[enemy][king]; });
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Game::hurdles(Square king, Square hurdle, Color color) const
+{
+	/* -- A piece landing on a line through the king may serve as hurdle to enemy hoppers on that line -- */
+
+	if (!m_hoppers)
+		return false;
+
+	const Tables::Magic& magic = m_orthogonals[king].lines()[hurdle] ? m_orthogonals[king] : m_diagonals[king];
+	if (!magic.lines()[hurdle])
+		return false;
+
+	const Squares blockers = m_position[White] | m_position[Black];
+	const Squares enemies = m_checks[color][king] & m_position[!color] & magic.lines();
 
-	return false;
+	return enemies.any([&](Square from) { const Glyph glyph = m_board[from]->state.glyph; return m_hoppers[glyph] && Tables::getHopperMoves(m_problem.piece(glyph), from, blockers, m_orthogonals, m_diagonals)[king]; });
 }
 
 /* -------------------------------------------------------------------------- */
@@ -3,6 +3,7 @@
 
 #include "includes.h"
 #include "hashtables.h"
+#include "tables/tables.h"
 
 namespace Euclide
 {
@@ -23,16 +24,21 @@ class Game
 
 		void play();
 
+		inline bool hugePages() const
+			{ return m_cache.huge(); }
+
 	protected:
 		class State;
-		bool play(const State& state);
+		template <bool Fairy> bool play(const State& state);
 
 		State move(const State& state, Square from, Square to, Glyph glyph, CastlingSide castling);
-		void undo(const State& state);
+		void undo(const State& state, const State& previous);
 
-		bool checks(Glyph glyph, Square from, Square king) const;
-		bool checked(Square king, Color color) const;
-		bool checked(Square king, Square free, Color color) const;
+		template <bool Fairy> bool checks(Glyph glyph, Square from, Square king) const;
+		template <bool Fairy> bool checked(Square king, Color color) const;
+		template <bool Fairy> bool checked(Square king, Square free, Color color) const;
+		bool exposes(Square king, Square from, Color color) const;
+		bool hurdles(Square king, Square hurdle, Color color) const;
 
 		bool solved() const;
 		void cmoves(EUCLIDE_Move *moves, int nmoves) const;
@@ -98,9 +104,16 @@ class Game
 		const Problem& m_problem;                           /**< Problem to solve. */
 		const array<Pieces, NumColors>& m_pieces;           /**< Problem pieces. */
 
-		array<ArrayOfSquares, NumGlyphs> m_captures;        /**< Legal captures, for checks. */
-		array<MatrixOfSquares, NumGlyphs> m_constraints;    /**< Move constraints, for checks. */
-		array<MatrixOfSquares, NumColors> m_lines;          /**< Line of sights, for checks and discovered checks. */
+		array<const ArrayOfSquares *, NumGlyphs> m_captures;    /**< Legal captures, for checks. */
+		array<ArrayOfSquares, NumColors> m_checks;          /**< Squares enemy pieces may check each king square from. */
+		Glyphs m_runners;                                   /**< Glyphs checking along rook and bishop lines. */
+		Glyphs m_hoppers;                                   /**< Glyphs moving and checking over a hurdle. */
+
+		const Tables::Magics& m_orthogonals;                /**< Rook lines attack tables, for checks. */
+		const Tables::Magics& m_diagonals;                  /**< Bishop lines attack tables, for checks. */
+
+		array<const MatrixOfSquares *, NumGlyphs> m_constraints;            /**< Move constraints of fairy riders, for checks. */
+		const array<MatrixOfSquares, NumColors> *m_lines;                   /**< Line of sights of fairy riders and hoppers, for discovered checks. */
 
 		array<const Piece *, NumSquares> m_board;           /**< Current board position. */
 		array<Squares, NumColors> m_position;               /**< Current occupied squares. */
@@ -6,8 +6,35 @@ namespace Euclide
 
 /* -------------------------------------------------------------------------- */
 
+static uint64_t splitmix(uint64_t& seed)
+{
+	uint64_t value = (seed += UINT64_C(0x9E3779B97F4A7C15));
+	value = (value ^ (value >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+	value = (value ^ (value >> 27)) * UINT64_C(0x94D049BB133111EB);
+	return value ^ (value >> 31);
+}
+
+/* -- Zobrist keys of each four bit value on each square, the empty square being left out of signatures -- */
+
+static const matrix<uint64_t, NumSquares, 16> Keys = []()
+{
+	matrix<uint64_t, NumSquares, 16> keys(0);
+
+	uint64_t seed = 0;
+	for (Square square : AllSquares())
+		for (int value = 1; value < 16; value++)
+			keys[square][value] = splitmix(seed);
+
+	return keys;
+}();
+
+/* -------------------------------------------------------------------------- */
+
 HashPosition::HashPosition(const Problem& problem)
 {
+	m_glyphs.fill(0);
+	m_signature = 0;
+
 	for (Square square : AllSquares())
 		set(square, problem.initialPosition()[square]);
 
@@ -22,10 +49,11 @@ void HashPosition::set(Square square, Glyph glyph)
 	static_assert(NumGlyphs <= 16);
 	assert(glyph <= 15);
 
-	if (square & 1)
-		m_glyphs[square >> 1] = (glyph << 4) | (m_glyphs[square >> 1] & 0x0F);
-	else
-		m_glyphs[square >> 1] = (glyph << 0) | (m_glyphs[square >> 1] & 0xF0);
+	uint8_t& glyphs = m_glyphs[square >> 1];
+	const int shift = (square & 1) ? 4 : 0;
+
+	m_signature ^= Keys[square][(glyphs >> shift) & 0x0F] ^ Keys[square][glyph];
+	glyphs = (glyph << shift) | (glyphs & (0xF0 >> shift));
 }
 
 /* -------------------------------------------------------------------------- */
@@ -48,65 +76,54 @@ void HashPosition::set(Square square, const array<bool, NumCastlingSides>& castl
 
 /* -------------------------------------------------------------------------- */
 
-uint32_t HashPosition::hash() const
+static const int Chaining = 16;
+
+HashTable::HashTable(size_t size, bool huge, bool verify)
+	: m_pages(size, huge)
 {
-	static const bool wide = (sizeof(void *) >= sizeof(uint64_t));
-
-	if (wide)
-	{
-		uint64_t hash = UINT64_C(0xCBF29CE484222325);
-		for (unsigned k = 0; k < sizeof(m_glyphs) / sizeof(uint64_t); k++)
-		{
-			hash ^= reinterpret_cast<const uint64_t *>(m_glyphs.data())[k];
-			hash *= UINT64_C(0x00000100000001B3);
-		}
-
-		return (hash >> 32) & hash & UINT32_MAX;
-	}
-	else
-	{
-		uint32_t hash = UINT32_C(0x811C9DC5);
-		for (unsigned k = 0; k < sizeof(m_glyphs) / sizeof(uint32_t); k++)
-		{
-			hash ^= reinterpret_cast<const uint32_t *>(m_glyphs.data())[k];
-			hash *= UINT32_C(0x01000193);
-		}
-
-		return hash;
-	}
-}
+	/* -- Fit as many entries as possible, made of a signature, and of the whole position in verify mode -- */
 
-/* -------------------------------------------------------------------------- */
+	const size_t entry = sizeof(uint64_t) + (verify ? sizeof(HashPosition::Nibbles) : 0);
 
-HashTable::HashTable(int capacity)
-{
-	assert(intel::popcnt(uint32_t(capacity)) == 1);
-	m_size = std::min(1024, m_capacity = capacity);
+	for (m_capacity = 1; (2 * m_capacity + Chaining) * entry <= size; )
+		m_capacity *= 2;
+
+	m_size = std::min(1024, m_capacity);
 
 	m_mask = m_size - 1;
-	m_chaining = 16;
+	m_chaining = Chaining;
 
 	m_grow = 0;
 
-	/* -- Create empty hash table -- */
+	/* -- Memory comes zero filled, i.e. as an empty hash table -- */
+
+	m_signatures = m_pages.as<uint64_t>();
+	m_positions = verify ? reinterpret_cast<HashPosition::Nibbles *>(m_signatures + m_capacity + m_chaining) : nullptr;
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint64_t HashTable::signature(const HashPosition& position, int moves)
+{
+	/* -- Mix in number of moves, and keep signatures odd so that zero marks empty entries -- */
 
-	m_entries.reset(new HashEntry[m_capacity + m_chaining]);
-	for (int k = 0; k < m_size + m_chaining; k++)
-		m_entries[k].hash = std::numeric_limits<uint32_t>::max();
+	return (position.signature() ^ (uint64_t(moves) * UINT64_C(0x9E3779B97F4A7C15))) | 1;
 }
 
 /* -------------------------------------------------------------------------- */
 
 void HashTable::insert(const HashPosition& position, int moves)
 {
-	uint32_t hash = position.hash() ^ moves;
-	uint32_t index = hash & m_mask;
+	const uint64_t signature = HashTable::signature(position, moves);
+	uint32_t index = uint32_t(signature >> 32) & m_mask;
 
 	for (int k = 0; k < m_chaining; k++, index++)
-		if (m_entries[index].hash == std::numeric_limits<uint32_t>::max())
+		if (!m_signatures[index])
 			break;
 
-	m_entries[index] = { position, moves, hash };
+	m_signatures[index] = signature;
+	if (m_positions)
+		m_positions[index] = position.glyphs();
 
 	/* -- Grow hash table if it seems pertinent -- */
 
@@ -119,14 +136,15 @@ void HashTable::insert(const HashPosition& position, int moves)
 
 bool HashTable::contains(const HashPosition& position, int moves)
 {
-	uint32_t hash = position.hash() ^ moves;
-	uint32_t index = hash & m_mask;
+	const uint64_t signature = HashTable::signature(position, moves);
+	uint32_t index = uint32_t(signature >> 32) & m_mask;
 
-	for (int k = 0; k <= m_chaining; k++, index++)
-		if (m_entries[index].hash == hash)
-			if (m_entries[index].moves == moves)
-				if (m_entries[index].position == position)
-					return true;
+	/* -- Entries are never removed, so an empty entry ends the search -- */
+
+	for (int k = 0; (k <= m_chaining) && m_signatures[index]; k++, index++)
+		if (m_signatures[index] == signature)
+			if (!m_positions || (m_positions[index] == position.glyphs()))
+				return true;
 
 	return false;
 }
@@ -137,14 +155,15 @@ void HashTable::grow()
 {
 	assert(m_size < m_capacity);
 
-	std::copy_n(m_entries.get(), m_size, m_entries.get() + m_size);
+	std::copy_n(m_signatures, m_size, m_signatures + m_size);
+	if (m_positions)
+		std::copy_n(m_positions, m_size, m_positions + m_size);
+
 	m_mask = (m_size *= 2) - 1;
 
-	for (int k = m_size; k < m_size + m_chaining; k++)
-		m_entries[k].hash = std::numeric_limits<uint32_t>::max();
+	std::fill_n(m_signatures + m_size, m_chaining, 0);
 }
 
 /* -------------------------------------------------------------------------- */
 
-
 }
@@ -2,6 +2,7 @@
 #define __EUCLIDE_HASH_TABLES_H
 
 #include "includes.h"
+#include "utilities/pages.h"
 
 namespace Euclide
 {
@@ -12,6 +13,9 @@ class Problem;
 
 class HashPosition
 {
+	public:
+		typedef array<uint8_t, NumSquares / 2> Nibbles;
+
 	public:
 		HashPosition() {}
 		HashPosition(const Problem& problem);
@@ -39,14 +43,18 @@ class HashPosition
 		inline bool operator!=(const HashPosition& position) const
 			{ return m_glyphs != position.m_glyphs; }
 
-		uint32_t hash() const;
+		inline const Nibbles& glyphs() const
+			{ return m_glyphs; }
+		inline uint64_t signature() const
+			{ return m_signature; }
 
 	protected:
 		void set(Square square, Glyph glyph);
 		void set(Square square, const array<bool, NumCastlingSides>& castlings);
 
 	private:
-		array<uint8_t, NumSquares / 2> m_glyphs;    /**< Glyphs, four bits each. Castling rights are encoded with the kings. */
+		Nibbles m_glyphs;                           /**< Glyphs, four bits each. Castling rights are encoded with the kings. */
+		uint64_t m_signature;                       /**< Zobrist signature of above glyphs, updated along with them. */
 };
 
 /* -------------------------------------------------------------------------- */
@@ -54,17 +62,22 @@ class HashPosition
 class HashTable
 {
 	public:
-		HashTable(int capacity);
+		HashTable(size_t size, bool huge, bool verify);
 
 		void insert(const HashPosition& position, int moves);
 		bool contains(const HashPosition& position, int moves);
 
+		inline bool huge() const
+			{ return m_pages.huge(); }
+
 	protected:
+		static uint64_t signature(const HashPosition& position, int moves);
 		void grow();
 
 	private:
-		struct HashEntry { HashPosition position; int32_t moves; uint32_t hash; };
-		std::unique_ptr<HashEntry[]> m_entries;    /**< Hash table of positions and associated data. */
+		Pages m_pages;                             /**< Memory holding the hash table, on huge pages if requested and available. */
+		uint64_t *m_signatures;                    /**< Signatures of cached positions and their number of moves, zero for empty entries. */
+		HashPosition::Nibbles *m_positions;        /**< Cached positions, only kept in verify mode to rule out signature collisions. */
 
 		int m_capacity;                            /**< Maximum capacity of the hash table. */
 		int m_size;                                /**< Current size of the hash table. */
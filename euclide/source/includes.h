@@ -24,15 +24,22 @@
 
 #include <array>
 #include <algorithm>
+#include <atomic>
 #include <bitset>
+#include <condition_variable>
+#include <exception>
 #include <functional>
 #include <iterator>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <new>
 #include <numeric>
 #include <queue>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 using std::array;
@@ -44,6 +51,10 @@ using std::tuple;
 	#include <intrin.h>
 #endif
 
+#ifdef EUCLIDE_LINUX_IMPLEMENTATION
+	#include <immintrin.h>
+#endif
+
 /* -------------------------------------------------------------------------- */
 
 #define countof(array) std::extent<decltype(array)>::value
@@ -65,6 +76,7 @@ static inline bool is(tribool value) { return bool(value); }
 static inline bool maybe(tribool value) { return bool(value) || unknown(value); }
 
 #include "utilities/algorithm.h"
+#include "utilities/arena.h"
 #include "utilities/bitset.h"
 #include "utilities/iterator.h"
 #include "utilities/matrix.h"
@@ -2,6 +2,7 @@
 #include "captures.h"
 #include "targets.h"
 #include "pieces.h"
+#include "utilities/assignment.h"
 
 namespace Euclide
 {
@@ -10,7 +11,8 @@ namespace Euclide
 /* -- Partition                                                            -- */
 /* -------------------------------------------------------------------------- */
 
-Partition::Partition()
+Partition::Partition(Arena& arena)
+	: m_destinations(ArenaAllocator<Destination>(arena))
 {
 	m_requiredMoves = 0;
 	m_requiredCaptures = 0;
@@ -91,57 +93,32 @@ void Partition::assign(const Pieces& pieces)
 	m_requiredMoves = std::max(m_requiredMoves, m_assignedRequiredMoves);
 	m_requiredCaptures = std::max(m_requiredCaptures, m_assignedRequiredCaptures);
 
-	/* -- Find required moves and captures by trying all men permutations, if reasonable -- */
+	/* -- Precompute required moves and captures for all possibilities -- */
 
-	constexpr int MaxMen = 8;
-	int minRequiredMoves = (m > MaxMen) ? m_requiredMoves : Infinity;
-	int minRequiredCaptures = (m > MaxMen) ? m_requiredCaptures : Infinity;
+	struct Cost { int moves; int captures; };
+	matrix<Cost, MaxPieces, MaxPieces> costs;
 
-	if (m <= MaxMen)
+	int i = 0;
+	for (Man man : ValidMen(m_men))
 	{
-		struct Cost { int moves; int captures; };
-		matrix<Cost, MaxMen, MaxMen> costs;
-
-		/* -- Precompute required moves and captures for all possibilities -- */
-
-		int i = 0;
-		for (Man man : ValidMen(m_men))
+		for (int j = 0; j < s; j++)
 		{
-			for (int j = 0; j < s; j++)
-			{
-				const Destination& destination = m_destinations[j];
-
-				costs[i][j].moves = destination.men[man] ? std::max(destination.glyph ? pieces[man].requiredMovesTo(destination.squares, destination.glyph) : pieces[man].requiredMovesTo(destination.squares), pieces[man].requiredMoves()) : Infinity;
-				costs[i][j].captures = destination.men[man] ? std::max(destination.glyph ? pieces[man].requiredCapturesTo(destination.squares, destination.glyph) : pieces[man].requiredCapturesTo(destination.squares), pieces[man].requiredCaptures()) : Infinity;
-			}
+			const Destination& destination = m_destinations[j];
 
-			i += 1;
+			costs[i][j].moves = destination.men[man] ? std::max(destination.glyph ? pieces[man].requiredMovesTo(destination.squares, destination.glyph) : pieces[man].requiredMovesTo(destination.squares), pieces[man].requiredMoves()) : Infinity;
+			costs[i][j].captures = destination.men[man] ? std::max(destination.glyph ? pieces[man].requiredCapturesTo(destination.squares, destination.glyph) : pieces[man].requiredCapturesTo(destination.squares), pieces[man].requiredCaptures()) : Infinity;
 		}
 
-		/* -- Find required moves and captures by trying all permutations of men and squares -- */
-
-		int indices[MaxMen];
-		for (int k = 0; k < m; k++)
-			indices[k] = k;
-
-		do
-		{
-			int requiredMoves = 0, requiredCaptures = 0;
-
-			for (int k = 0; k < s; k++)
-			{
-				requiredMoves += costs[indices[k]][k].moves;
-				requiredCaptures += costs[indices[k]][k].captures;
-			}
+		i += 1;
+	}
 
-			xstd::minimize(minRequiredMoves, requiredMoves);
-			xstd::minimize(minRequiredCaptures, requiredCaptures);
+	/* -- Find required moves and captures by solving the assignment problems between destinations and men -- */
 
-			if ((minRequiredMoves <= m_requiredMoves) && (minRequiredCaptures <= m_requiredCaptures))
-				break;
+	const Assignment<MaxPieces> moves(s, m, [&](int destination, int man) { return costs[man][destination].moves; });
+	const Assignment<MaxPieces> captures(s, m, [&](int destination, int man) { return costs[man][destination].captures; });
 
-		} while (std::next_permutation(indices, indices + m));
-	}
+	const int minRequiredMoves = std::max(moves.cost(), m_requiredMoves);
+	const int minRequiredCaptures = std::max(captures.cost(), m_requiredCaptures);
 
 	/* -- Update required moves and captures -- */
 
@@ -239,16 +216,10 @@ bool Partition::split(Pieces& pieces, Glyph glyph, int availableMoves, int avail
 	if (m < s)
 		throw NoSolution;
 
-	/* -- Early exit if computations are too expensive -- */
-
-	static constexpr int MaxMen = 8;
-	if (m > MaxMen)
-		return false;
-
 	/* -- Prefetch required moves and captures -- */
 
 	struct Cost { int moves; int captures; };
-	matrix<Cost, MaxMen, MaxMen> costs;
+	matrix<Cost, MaxPieces, MaxPieces> costs;
 
 	for (int i = 0; i < m; i++)
 	{
@@ -263,43 +234,76 @@ bool Partition::split(Pieces& pieces, Glyph glyph, int availableMoves, int avail
 		}
 	}
 
-	/* -- Try all permutations -- */
-
 	array<Men, MaxPieces> permutations;
 	array<Squares, MaxPieces> squares;
 
-	int indices[MaxMen];
-	for (int k = 0; k < m; k++)
-		indices[k] = k;
+	/* -- Try all permutations, if reasonable -- */
 
-	do
+	static constexpr int MaxMen = 8;
+	if (m <= MaxMen)
 	{
-		int requiredMoves = 0, requiredCaptures = 0;
-
-		for (int k = 0; k < s; k++)
-		{
-			requiredMoves += costs[indices[k]][k].moves;
-			requiredCaptures += costs[indices[k]][k].captures;
-		}
+		int indices[MaxMen];
+		for (int k = 0; k < m; k++)
+			indices[k] = k;
 
-		if ((requiredMoves <= availableMoves) && (requiredCaptures <= availableCaptures))
+		do
 		{
-			for (int k = 0; k < m; k++)
-				permutations[k].set(men[indices[k]]);
+			int requiredMoves = 0, requiredCaptures = 0;
 
 			for (int k = 0; k < s; k++)
 			{
-				const int myAvailableMoves = costs[indices[k]][k].moves + (availableMoves - requiredMoves);
-				const int myAvailableCaptures = costs[indices[k]][k].captures + (availableCaptures - requiredCaptures);
+				requiredMoves += costs[indices[k]][k].moves;
+				requiredCaptures += costs[indices[k]][k].captures;
+			}
+
+			if ((requiredMoves <= availableMoves) && (requiredCaptures <= availableCaptures))
+			{
+				for (int k = 0; k < m; k++)
+					permutations[k].set(men[indices[k]]);
+
+				for (int k = 0; k < s; k++)
+				{
+					const int myAvailableMoves = costs[indices[k]][k].moves + (availableMoves - requiredMoves);
+					const int myAvailableCaptures = costs[indices[k]][k].captures + (availableCaptures - requiredCaptures);
+
+					const Destination& destination = m_destinations[destinations[k]];
+					const Squares reachableSquares = destination.glyph ? pieces[men[indices[k]]].reachableSquares(destination.squares, myAvailableMoves, myAvailableCaptures, destination.glyph) : pieces[men[indices[k]]].reachableSquares(destination.squares, myAvailableMoves, myAvailableCaptures);
+
+					squares[indices[k]] |= reachableSquares;
+				}
+			}
+
+		} while (std::next_permutation(indices, indices + m));
+	}
+
+	/* -- Otherwise, bound the cost of all assignments using a given man for a given destination with the reduced costs of optimal assignments -- */
+
+	else
+	{
+		const Assignment<MaxPieces> moves(s, m, [&](int destination, int man) { return costs[man][destination].moves; });
+		const Assignment<MaxPieces> captures(s, m, [&](int destination, int man) { return costs[man][destination].captures; });
+
+		for (int k = 0; k < s; k++)
+		{
+			for (int i = 0; i < m; i++)
+			{
+				const int requiredMoves = moves.cost() + moves.reduced(k, i);
+				const int requiredCaptures = captures.cost() + captures.reduced(k, i);
+
+				if ((requiredMoves > availableMoves) || (requiredCaptures > availableCaptures))
+					continue;
+
+				const int myAvailableMoves = costs[i][k].moves + (availableMoves - requiredMoves);
+				const int myAvailableCaptures = costs[i][k].captures + (availableCaptures - requiredCaptures);
 
 				const Destination& destination = m_destinations[destinations[k]];
-				const Squares reachableSquares = destination.glyph ? pieces[men[indices[k]]].reachableSquares(destination.squares, myAvailableMoves, myAvailableCaptures, destination.glyph) : pieces[men[indices[k]]].reachableSquares(destination.squares, myAvailableMoves, myAvailableCaptures);
+				const Squares reachableSquares = destination.glyph ? pieces[men[i]].reachableSquares(destination.squares, myAvailableMoves, myAvailableCaptures, destination.glyph) : pieces[men[i]].reachableSquares(destination.squares, myAvailableMoves, myAvailableCaptures);
 
-				squares[indices[k]] |= reachableSquares;
+				permutations[k].set(men[i]);
+				squares[i] |= reachableSquares;
 			}
 		}
-
-	} while (std::next_permutation(indices, indices + m));
+	}
 
 	/* -- Update targets and captures -- */
 
@@ -446,7 +450,8 @@ int Partition::unassignedRequiredCaptures(Man man) const
 /* -- Partitions                                                           -- */
 /* -------------------------------------------------------------------------- */
 
-Partitions::Partitions(const Pieces& pieces, const Targets& targets, const Captures& captures)
+Partitions::Partitions(const Pieces& pieces, const Targets& targets, const Captures& captures, Arena& arena)
+	: std::vector<Partition, ArenaAllocator<Partition>>(ArenaAllocator<Partition>(arena)), m_null(arena)
 {
 	assert(targets.size() + captures.size() == pieces.size());
 	reserve(pieces.size());
@@ -461,7 +466,7 @@ Partitions::Partitions(const Pieces& pieces, const Targets& targets, const Captu
 
 	while (targetPool || capturePool)
 	{
-		Partition partition;
+		Partition partition(arena);
 
 		for (bool updated = true; updated; )
 		{
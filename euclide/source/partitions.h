@@ -19,7 +19,7 @@ class Captures;
 class Partition
 {
 	public:
-		Partition();
+		Partition(Arena& arena);
 
 		bool merge(const Target& target);
 		bool merge(const Capture& capture);
@@ -80,7 +80,8 @@ class Partition
 			const Capture *capture;
 		};
 
-		std::vector<Destination> m_destinations;    /**< Target and capture locations. */
+		typedef std::vector<Destination, ArenaAllocator<Destination>> Destinations;
+		Destinations m_destinations;                /**< Target and capture locations. */
 
 		int m_requiredMoves;                        /**< Required moves. */
 		int m_requiredCaptures;                     /**< Required captures. */
@@ -99,10 +100,10 @@ class Partition
 /* -- Partitions                                                           -- */
 /* -------------------------------------------------------------------------- */
 
-class Partitions : public std::vector<Partition>
+class Partitions : public std::vector<Partition, ArenaAllocator<Partition>>
 {
 	public:
-		Partitions(const Pieces& pieces, const Targets& targets, const Captures& captures);
+		Partitions(const Pieces& pieces, const Targets& targets, const Captures& captures, Arena& arena);
 
 	public:
 		inline int requiredMoves() const
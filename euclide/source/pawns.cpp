@@ -0,0 +1,263 @@
+#include "pawns.h"
+#include "targets.h"
+#include "pieces.h"
+
+namespace Euclide
+{
+
+/* -------------------------------------------------------------------------- */
+/* -- PawnStructure                                                        -- */
+/* -------------------------------------------------------------------------- */
+
+PawnStructure::PawnStructure(const Pieces& pieces, const Targets& targets, Color color, int availableMoves, int availableCaptures)
+{
+	m_glyph = color ? BlackPawn : WhitePawn;
+
+	m_men.fill(Men());
+	m_squares.fill(Squares());
+	m_disappear.fill(true);
+
+	m_requiredMoves.fill(0);
+	m_requiredCaptures.fill(0);
+
+	/* -- List pawns, i.e. men that may end as pawns, and pawn targets, which only they can fill -- */
+
+	array<Man, MaxPieces> pawns;
+	int n = 0;
+
+	for (const Piece& piece : pieces)
+		if (piece.glyphs()[m_glyph])
+			pawns[n++] = piece.man();
+
+	array<int, MaxTargets> destinations;
+	int k = 0;
+
+	for (int target = 0; target < int(targets.size()); target++)
+		if (targets[target].glyph() == m_glyph)
+			if (k++ < MaxTargets)
+				destinations[k - 1] = target;
+
+	if (k > MaxTargets)
+		return;
+
+	/* -- Moves and captures left to pawns by other pieces -- */
+
+	for (const Piece& piece : pieces)
+		if (!piece.glyphs()[m_glyph])
+			availableMoves -= piece.requiredMoves(), availableCaptures -= piece.requiredCaptures();
+
+	if ((availableMoves < 0) || (availableCaptures < 0))
+		throw NoSolution;
+
+	/* -- Cost of each pawn fate: filling one of the pawn targets, or disappearing by being captured or promoted -- */
+
+	matrix<int, MaxPieces, MaxTargets + 1> moves;
+	matrix<int, MaxPieces, MaxTargets + 1> captures;
+
+	for (int i = 0; i < n; i++)
+	{
+		const Piece& pawn = pieces[pawns[i]];
+
+		for (int j = 0; j < k; j++)
+		{
+			const Target& target = targets[destinations[j]];
+
+			moves[i][j] = Infinity;
+			captures[i][j] = Infinity;
+
+			if (target.men()[pawn.man()] && pawn.squares(m_glyph)[target.square()])
+			{
+				const int requiredMoves = std::max(pawn.requiredMovesTo(target.square(), m_glyph), pawn.requiredMoves());
+				const int requiredCaptures = std::max(pawn.requiredCapturesTo(target.square(), m_glyph), pawn.requiredCaptures());
+
+				if ((requiredMoves <= pawn.availableMoves()) && (requiredCaptures <= pawn.availableCaptures()))
+					moves[i][j] = requiredMoves, captures[i][j] = requiredCaptures;
+			}
+		}
+
+		const bool disappear = maybe(pawn.captured()) || (pawn.glyphs() - m_glyph).any();
+
+		moves[i][k] = disappear ? pawn.requiredMoves() : Infinity;
+		captures[i][k] = disappear ? pawn.requiredCaptures() : Infinity;
+	}
+
+	/* -- Minimum moves of all pawn structures, memoized over filled targets and captures used, from both ends -- */
+
+	const int masks = 1 << k;
+	const int full = masks - 1;
+
+	auto index = [&](int pawn, int mask, int captures) { return (pawn * masks + mask) * (availableCaptures + 1) + captures; };
+
+	std::vector<int> forward((n + 1) * masks * (availableCaptures + 1), Infinity);
+	std::vector<int> backward((n + 1) * masks * (availableCaptures + 1), Infinity);
+
+	for (int c = 0; c <= availableCaptures; c++)
+		backward[index(n, full, c)] = 0;
+
+	for (int i = n; i-- > 0; )
+	{
+		for (int mask = 0; mask < masks; mask++)
+		{
+			for (int c = 0; c <= availableCaptures; c++)
+			{
+				int& best = backward[index(i, mask, c)];
+
+				for (int j = 0; j <= k; j++)
+				{
+					if ((moves[i][j] >= Infinity) || (c + captures[i][j] > availableCaptures))
+						continue;
+
+					if ((j < k) && (mask & (1 << j)))
+						continue;
+
+					const int next = backward[index(i + 1, (j < k) ? (mask | (1 << j)) : mask, c + captures[i][j])];
+					if (next < Infinity)
+						xstd::minimize(best, moves[i][j] + next);
+				}
+			}
+		}
+	}
+
+	if (backward[index(0, 0, 0)] > availableMoves)
+		throw NoSolution;
+
+	forward[index(0, 0, 0)] = 0;
+
+	for (int i = 0; i < n; i++)
+	{
+		for (int mask = 0; mask < masks; mask++)
+		{
+			for (int c = 0; c <= availableCaptures; c++)
+			{
+				const int previous = forward[index(i, mask, c)];
+				if (previous >= Infinity)
+					continue;
+
+				for (int j = 0; j <= k; j++)
+				{
+					if ((moves[i][j] >= Infinity) || (c + captures[i][j] > availableCaptures))
+						continue;
+
+					if ((j < k) && (mask & (1 << j)))
+						continue;
+
+					xstd::minimize(forward[index(i + 1, (j < k) ? (mask | (1 << j)) : mask, c + captures[i][j])], previous + moves[i][j]);
+				}
+			}
+		}
+	}
+
+	/* -- Keep pawn fates that belong to at least one pawn structure fitting in available moves and captures -- */
+
+	for (int i = 0; i < n; i++)
+	{
+		const Man man = pawns[i];
+
+		int requiredMoves = Infinity;
+		int requiredCaptures = Infinity;
+		m_disappear[man] = false;
+
+		for (int j = 0; j <= k; j++)
+		{
+			if ((moves[i][j] >= Infinity) || (captures[i][j] > availableCaptures))
+				continue;
+
+			bool possible = false;
+			for (int mask = 0; (mask < masks) && !possible; mask++)
+			{
+				if ((j < k) && (mask & (1 << j)))
+					continue;
+
+				for (int c = 0; c + captures[i][j] <= availableCaptures; c++)
+				{
+					const int previous = forward[index(i, mask, c)];
+					const int next = backward[index(i + 1, (j < k) ? (mask | (1 << j)) : mask, c + captures[i][j])];
+
+					if ((previous < Infinity) && (next < Infinity) && (previous + moves[i][j] + next <= availableMoves))
+					{
+						possible = true;
+						break;
+					}
+				}
+			}
+
+			if (!possible)
+				continue;
+
+			if (j < k)
+			{
+				m_men[destinations[j]].set(man);
+				m_squares[man].set(targets[destinations[j]].square());
+			}
+			else
+			{
+				m_disappear[man] = true;
+			}
+
+			xstd::minimize(requiredMoves, moves[i][j]);
+			xstd::minimize(requiredCaptures, captures[i][j]);
+		}
+
+		if (requiredMoves >= Infinity)
+			throw NoSolution;
+
+		m_requiredMoves[man] = requiredMoves;
+		m_requiredCaptures[man] = requiredCaptures;
+		m_pawns.set(man);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool PawnStructure::update(Pieces& pieces, Targets& targets) const
+{
+	bool updated = false;
+
+	if (!m_pawns)
+		return updated;
+
+	/* -- Restrict pawns that may fill each pawn target -- */
+
+	for (int target = 0; target < int(targets.size()); target++)
+		if (targets[target].glyph() == m_glyph)
+			if (targets[target].updatePossibleMen(m_men[target]))
+				updated = true;
+
+	/* -- Restrict pawns fates, and update their required moves and captures -- */
+
+	for (Man man : ValidMen(m_pawns))
+	{
+		Piece& pawn = pieces[man];
+
+		const Glyphs glyphs = pawn.glyphs();
+		const Squares squares = pawn.squares();
+		const tribool captured = pawn.captured();
+		const int requiredMoves = pawn.requiredMoves();
+		const int requiredCaptures = pawn.requiredCaptures();
+
+		if (!m_disappear[man])
+		{
+			pawn.setCaptured(false);
+			pawn.setPossibleGlyphs(m_glyph);
+			pawn.setPossibleSquares(m_squares[man]);
+		}
+
+		if (!m_squares[man] && !maybe(pawn.captured()))
+			pawn.setPossibleGlyphs(pawn.glyphs() - m_glyph);
+
+		pawn.setRequiredMoves(m_requiredMoves[man]);
+		pawn.setRequiredCaptures(m_requiredCaptures[man]);
+
+		if ((pawn.glyphs() != glyphs) || (pawn.squares() != squares) || (unknown(captured) && !unknown(pawn.captured())))
+			updated = true;
+
+		if ((pawn.requiredMoves() != requiredMoves) || (pawn.requiredCaptures() != requiredCaptures))
+			updated = true;
+	}
+
+	return updated;
+}
+
+/* -------------------------------------------------------------------------- */
+
+}
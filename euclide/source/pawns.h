@@ -0,0 +1,41 @@
+#ifndef __EUCLIDE_PAWNS_H
+#define __EUCLIDE_PAWNS_H
+
+#include "includes.h"
+
+namespace Euclide
+{
+
+class Pieces;
+class Targets;
+
+/* -------------------------------------------------------------------------- */
+/* -- PawnStructure                                                        -- */
+/* -------------------------------------------------------------------------- */
+
+class PawnStructure
+{
+	public:
+		PawnStructure(const Pieces& pieces, const Targets& targets, Color color, int availableMoves, int availableCaptures);
+
+		bool update(Pieces& pieces, Targets& targets) const;
+
+	private:
+		static const int MaxTargets = 10;              /**< Pawn structures with more pawn targets are not analyzed. */
+
+		Glyph m_glyph;                                 /**< Pawn glyph. */
+		Men m_pawns;                                   /**< Analyzed pawns, i.e. men that may end as pawns. */
+
+		array<Men, MaxPieces> m_men;                   /**< Pawns that may fill each target, Men() for non pawn targets. */
+		array<Squares, MaxPieces> m_squares;           /**< Pawn targets each pawn may fill. */
+		array<bool, MaxPieces> m_disappear;            /**< Set if the pawn may be captured or promoted instead. */
+
+		array<int, MaxPieces> m_requiredMoves;         /**< Required moves of each pawn, over all consistent pawn structures. */
+		array<int, MaxPieces> m_requiredCaptures;      /**< Required captures of each pawn, over all consistent pawn structures. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+}
+
+#endif
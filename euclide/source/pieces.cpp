@@ -3,6 +3,7 @@
 #include "problem.h"
 #include "tables/tables.h"
 #include "cache.h"
+#include "utilities/kernels.h"
 
 namespace Euclide
 {
@@ -11,7 +12,8 @@ namespace Euclide
 /* -- Piece                                                                -- */
 /* -------------------------------------------------------------------------- */
 
-Piece::Piece(const Problem& problem, Square square, Man man, Glyph glyph, tribool promoted)
+Piece::Piece(const Problem& problem, Square square, Man man, Arena& arena, Glyph glyph, tribool promoted)
+	: m_personalities(ArenaAllocator<Piece>(arena))
 {
 	/* -- Piece initial characteristics -- */
 
@@ -64,17 +66,23 @@ Piece::Piece(const Problem& problem, Square square, Man man, Glyph glyph, triboo
 
 	/* -- Initialize legal moves and move tables -- */
 
-	Tables::initializeLegalMoves(&m_moves, m_glyph ? m_species : Pawn, m_color, problem.variant(), m_availableCaptures ? unknown : tribool(false), maybe(m_promoted));
+	m_legalMoves = Tables::getLegalMoves(m_glyph ? m_species : Pawn, m_color, problem.variant(), m_availableCaptures ? unknown : tribool(false), maybe(m_promoted));
+	m_moves = *m_legalMoves;
 	m_xmoves = Tables::getCaptureMoves(m_glyph ? m_species : Pawn, m_color, problem.variant());
 
-	m_constraints = Tables::getMoveConstraints(m_glyph ? m_species : Pawn, problem.variant(), false);
+	/* -- Cannons jump over a hurdle when capturing, so the analysis, which does not tell captures apart, may only rely on their capture constraints -- */
+
+	const bool cannon = m_glyph && ((m_species == Leo) || (m_species == Pao) || (m_species == Vao));
+
+	m_constraints = Tables::getMoveConstraints(m_glyph ? m_species : Pawn, problem.variant(), cannon);
 	m_xconstraints = Tables::getMoveConstraints(m_glyph ? m_species : Pawn, problem.variant(), true);
 
 	m_checks = Tables::getUnstoppableChecks(m_glyph ? m_species : Pawn, m_color, problem.variant());
 
 	if (is(m_promoted))
 	{
-		Tables::initializeLegalMoves(&m_pawn.moves, Pawn, m_color, problem.variant(), m_availableCaptures ? unknown : tribool(false), true);
+		m_pawn.legalMoves = Tables::getLegalMoves(Pawn, m_color, problem.variant(), m_availableCaptures ? unknown : tribool(false), true);
+		m_pawn.moves = *m_pawn.legalMoves;
 		m_pawn.xmoves = Tables::getCaptureMoves(Pawn, m_color, problem.variant());
 
 		m_pawn.constraints = Tables::getMoveConstraints(Pawn, problem.variant(), false);
@@ -85,6 +93,7 @@ Piece::Piece(const Problem& problem, Square square, Man man, Glyph glyph, triboo
 	else
 	{
 		m_pawn.moves.fill(Squares());
+		m_pawn.legalMoves = nullptr;
 		m_pawn.xmoves = nullptr;
 
 		m_pawn.constraints = nullptr;
@@ -96,7 +105,9 @@ Piece::Piece(const Problem& problem, Square square, Man man, Glyph glyph, triboo
 	/* -- Initialize occupied squares -- */
 
 	for (Square square : AllSquares())
-		m_occupied[square].pieces.fill(nullptr);
+		m_occupied[square].pieces.fill(0);
+
+	m_occupiers.fill(nullptr);
 
 	/* -- Distances will be computed later -- */
 
@@ -136,6 +147,8 @@ Piece::Piece(const Problem& problem, Square square, Man man, Glyph glyph, triboo
 	/* -- Actions will be initialized later -- */
 
 	m_actions = nullptr;
+	m_occupy = false;
+	m_version = 0;
 
 	/* -- Initialize personalities, when the final glyph is not known -- */
 
@@ -147,7 +160,7 @@ Piece::Piece(const Problem& problem, Square square, Man man, Glyph glyph, triboo
 	if (!m_glyph)
 	{
 		for (Glyph glyph : ValidGlyphs(m_glyphs))
-			m_personalities.emplace_back(problem, m_initialSquare, m_man, glyph, glyph != m_child);
+			m_personalities.emplace_back(problem, m_initialSquare, m_man, arena, glyph, glyph != m_child);
 
 		for (Piece& personality : m_personalities)
 			m_pieces[personality.glyph()] = &personality;
@@ -160,13 +173,14 @@ Piece::Piece(const Problem& problem, Square square, Man man, Glyph glyph, triboo
 
 	m_update = true;
 	update();
+	updateOccupiedSquares();
 }
 
 /* -------------------------------------------------------------------------- */
 
 Piece::~Piece()
 {
-	delete m_actions;
+	Arena::destroy(m_actions);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -174,7 +188,10 @@ Piece::~Piece()
 void Piece::initializeActions()
 {
 	assert(!m_actions);
-	m_actions = new Actions(*this);
+
+	Arena& arena = m_personalities.get_allocator().arena();
+	m_actions = arena.create<Actions>(*this, arena);
+
 	updateConsequences();
 }
 
@@ -339,6 +356,11 @@ void Piece::bypassObstacles(const Piece& blocker)
 {
 	const Squares& obstacles = blocker.stops();
 
+	/* -- Nothing to do if the blocker never stands in our way -- */
+
+	if (!(obstacles & m_route) && (m_castlingSquare == Nowhere) && !m_royal)
+		return;
+
 	/* -- Handle personalities -- */
 
 	for (Piece& personality : m_personalities)
@@ -352,15 +374,13 @@ void Piece::bypassObstacles(const Piece& blocker)
 	if (is(m_promoted))
 		if ((obstacles & m_route).any())
 			for (Square from : ValidSquares(m_stops))
-				for (Square to : ValidSquares(m_pawn.moves[from]))
-					if (obstacles <= ((*m_pawn.constraints)[from][to] | from))
-						m_pawn.moves[from][to] = false, m_update = true;
+				if (const Squares blocked = m_pawn.moves[from] & obstructions((*m_pawn.constraints)[from], from, obstacles))
+					m_pawn.moves[from] -= blocked, m_update = true;
 
 	if ((obstacles & m_route).any())
 		for (Square from : ValidSquares(m_stops))
-			for (Square to : ValidSquares(m_moves[from]))
-				if (obstacles <= ((*m_constraints)[from][to] | from))
-					m_moves[from][to] = false, m_update = true;
+			if (const Squares blocked = m_moves[from] & obstructions((*m_constraints)[from], from, obstacles))
+				m_moves[from] -= blocked, m_update = true;
 
 	/* -- Castling -- */
 
@@ -388,22 +408,17 @@ int Piece::mutualInteractions(Piece& pieceA, Piece& pieceB, const array<int, Num
 
 	/* -- Don't bother if these two pieces can not interact with each other -- */
 
-	const Squares routes[2] = {
-		pieceA.m_route | ((enemies && pieceB.m_royal) ? pieceA.m_threats : Squares()),
-		pieceB.m_route | ((enemies && pieceA.m_royal) ? pieceB.m_threats : Squares())
-	};
-
-	if (!(routes[0] & routes[1]))
+	if (!interacts(pieceA, pieceB))
 		return requiredMoves;
 
-	/* -- Interactions with captures are not yet implemented -- */
+	/* -- Pieces whose promotion is still undecided are handled through their personalities -- */
 
-	if (maybe(pieceA.m_captured) || maybe(pieceB.m_captured))
+	if (unknown(pieceA.m_promoted) || unknown(pieceB.m_promoted))
 		return requiredMoves;
 
-	/* -- Interactions with promotions are not yet implemented -- */
+	/* -- Captures and promotions are only handled by the full analysis -- */
 
-	if (maybe(pieceA.m_promoted) || maybe(pieceB.m_promoted))
+	if (fast && (maybe(pieceA.m_captured) || maybe(pieceB.m_captured) || is(pieceA.m_promoted) || is(pieceB.m_promoted)))
 		return requiredMoves;
 
 	/* -- Compute available moves for these two pieces -- */
@@ -413,12 +428,6 @@ int Piece::mutualInteractions(Piece& pieceA, Piece& pieceB, const array<int, Num
 		requiredMoves + freeMoves[pieceA.m_color] + (enemies ? freeMoves[pieceB.m_color] : 0)
 	);
 
-	/* -- Use fast method if the search space is too large -- */
-
-	const int threshold = 5000;
-	if ((pieceA.nmoves() * pieceB.nmoves() > threshold) || (availableMoves - requiredMoves > 20))
-		fast = true;
-
 	/* -- Play all possible moves with these two pieces -- */
 
 	array<State, 2> states = {
@@ -456,12 +465,93 @@ int Piece::mutualInteractions(Piece& pieceA, Piece& pieceB, const array<int, Num
 				const Square occupied = state.squares[square].first();
 				if (!state.piece.m_occupied[square].squares[occupied])
 				{
+					const Piece& occupier = states[&state == &states[0]].piece;
+
 					state.piece.m_occupied[square].squares[occupied] = true;
-					state.piece.m_occupied[square].pieces[occupied] = &states[&state == &states[0]].piece;
+					state.piece.m_occupied[square].pieces[occupied] = occupier.occupier();
+					state.piece.m_occupiers[occupier.occupier()] = &occupier;
 					state.piece.m_update = true;
 				}
 			}
 
+			if (is(state.piece.m_promoted) && (state.pawnMoves[square] < state.piece.m_pawn.moves[square]))
+				state.piece.m_pawn.moves[square] = state.pawnMoves[square], state.piece.m_update = true;
+
+			if (state.distances[square] > state.piece.m_distances[square])
+				state.piece.m_distances[square] = state.distances[square], state.piece.m_update = true;
+		}
+	}
+
+	/* -- Done -- */
+
+	return newRequiredMoves;
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Piece::mutualInteractions(Piece& pieceA, Piece& pieceB, Piece& pieceC, const array<int, NumColors>& freeMoves)
+{
+	const array<Piece *, 3> pieces = { &pieceA, &pieceB, &pieceC };
+	const int requiredMoves = pieceA.m_requiredMoves + pieceB.m_requiredMoves + pieceC.m_requiredMoves;
+
+	/* -- Don't bother unless the routes of these three pieces mutually intersect -- */
+
+	if (!interacts(pieceA, pieceB) || !interacts(pieceA, pieceC) || !interacts(pieceB, pieceC))
+		return requiredMoves;
+
+	/* -- Pieces that do not move are handled as obstacles, captures, promotions and castling are left to the two piece analysis -- */
+
+	for (const Piece *piece : pieces)
+	{
+		if (!piece->m_availableMoves)
+			return requiredMoves;
+
+		if (maybe(piece->m_captured) || maybe(piece->m_promoted))
+			return requiredMoves;
+
+		if ((piece->m_castlingSquare != Nowhere) && !piece->m_distances[piece->m_castlingSquare])
+			return requiredMoves;
+	}
+
+	/* -- Compute available moves for these three pieces -- */
+
+	int availableMoves = requiredMoves;
+	for (Color color : AllColors())
+		if (xstd::any_of(pieces, [=](const Piece *piece) { return piece->m_color == color; }))
+			availableMoves += freeMoves[color];
+
+	xstd::minimize(availableMoves, pieceA.m_availableMoves + pieceB.m_availableMoves + pieceC.m_availableMoves);
+
+	/* -- Play all possible moves with these three pieces -- */
+
+	array<State, 3> states = {
+		State(pieceA, pieceA.m_availableMoves),
+		State(pieceB, pieceB.m_availableMoves),
+		State(pieceC, pieceC.m_availableMoves)
+	};
+
+	const int newRequiredMoves = fullplay(states, availableMoves);
+
+	/* -- The search may have been abandoned if the search space is too large -- */
+
+	if (newRequiredMoves < 0)
+		return requiredMoves;
+
+	if (newRequiredMoves >= Infinity)
+		throw NoSolution;
+
+	/* -- Store required moves, remove never played moves and update distances -- */
+
+	for (const State& state : states)
+	{
+		if (state.requiredMoves > state.piece.m_requiredMoves)
+			state.piece.m_requiredMoves = state.requiredMoves, state.piece.m_update = true;
+
+		for (Square square : AllSquares())
+		{
+			if (state.moves[square] < state.piece.m_moves[square])
+				state.piece.m_moves[square] = state.moves[square], state.piece.m_update = true;
+
 			if (state.distances[square] > state.piece.m_distances[square])
 				state.piece.m_distances[square] = state.distances[square], state.piece.m_update = true;
 		}
@@ -474,7 +564,20 @@ int Piece::mutualInteractions(Piece& pieceA, Piece& pieceB, const array<int, Num
 
 /* -------------------------------------------------------------------------- */
 
-void Piece::findConsequences(const std::array<Pieces, NumColors>& pieces)
+bool Piece::interacts(const Piece& pieceA, const Piece& pieceB)
+{
+	/* -- Pieces interact if their routes cross, or if one of them may check the other, royal, piece -- */
+
+	const bool enemies = pieceA.m_color != pieceB.m_color;
+	const Squares routeA = pieceA.m_route | ((enemies && pieceB.m_royal) ? pieceA.m_threats : Squares());
+	const Squares routeB = pieceB.m_route | ((enemies && pieceA.m_royal) ? pieceB.m_threats : Squares());
+
+	return (routeA & routeB).any();
+}
+
+/* -------------------------------------------------------------------------- */
+
+void Piece::findConsequences(const std::array<Pieces, NumColors>& pieces, DistancesCache& cache)
 {
 	/* -- Early exit conditions -- */
 
@@ -518,9 +621,17 @@ void Piece::findConsequences(const std::array<Pieces, NumColors>& pieces)
 						if (maybe(piece.m_promoted))
 							continue;
 
-						/* -- Find distances assuming final square is blocked, and record any extra moves required -- */
+						/* -- Find distances assuming final square is blocked, shared with other blockers having the same effect -- */
+
+						const bool enemies = (m_color != piece.m_color);
+						const DistancesCache::Key key = { &piece, maybe(piece.m_captured) ? Nowhere : final, (piece.m_royal && enemies) ? m_checks : nullptr, enemies, m_royal && enemies };
+
+						const array<int, NumSquares>& rdistances = cache.distances(key, piece.m_version, [&]() {
+							return maybe(piece.m_captured) ? piece.computeDistancesTo(piece.m_possibleSquares, false) : piece.computeDistancesTo(piece.m_possibleSquares, *this, final);
+						});
+
+						/* -- Record any extra moves required -- */
 
-						const array<int, NumSquares> rdistances = maybe(piece.m_captured) ? piece.computeDistancesTo(piece.m_possibleSquares, false) : piece.computeDistancesTo(piece.m_possibleSquares, *this, final);
 						for (Square square : ValidSquares(piece.m_stops - Squares(final)))
 						{
 							const int requiredMoves = std::min(piece.m_distances[square] + rdistances[square], Infinity);
@@ -550,24 +661,118 @@ void Piece::findConsequences(const std::array<Pieces, NumColors>& pieces)
 
 /* -------------------------------------------------------------------------- */
 
+void Piece::compileConsequences()
+{
+	if (m_actions)
+		m_actions->compile();
+}
+
+/* -------------------------------------------------------------------------- */
+
 bool Piece::update()
 {
-	bool updated = false;
-	for (Piece& personality : m_personalities)
-		if (personality.update())
-			updated = true;
+	/* -- Personalities must have been updated beforehand -- */
+
+	const bool updated = xstd::any_of(m_personalities, [](const Piece& personality) { return personality.m_occupy; });
 
 	if (!m_update && !updated)
-		return updated;
+		return false;
 
 	m_glyph ? unfold() : summarize();
 
 	m_update = false;
+	m_occupy = true;
+	m_version += 1;
 	return true;
 }
 
 /* -------------------------------------------------------------------------- */
 
+void Piece::updateOccupiedSquares()
+{
+	for (Piece& personality : m_personalities)
+		if (personality.m_occupy)
+			personality.updateOccupiedSquares();
+
+	/* -- Close occupied squares using the ones of occupying pieces, following only newly added squares -- */
+
+	for (Square square : AllSquares())
+	{
+		Occupied& occupied = m_occupied[square];
+
+		for (Squares added = occupied.squares; added; )
+		{
+			Squares next;
+			for (Square blocking : ValidSquares(added))
+			{
+				const Piece& occupier = *m_occupiers[occupied.pieces[blocking]];
+				const Occupied& others = occupier.m_occupied[blocking];
+
+				for (Square other : ValidSquares(others.squares - occupied.squares))
+				{
+					occupied.squares.set(other);
+					occupied.pieces[other] = others.pieces[other];
+					m_occupiers[others.pieces[other]] = occupier.m_occupiers[others.pieces[other]];
+					next.set(other);
+				}
+			}
+
+			added = next;
+		}
+	}
+
+	m_occupy = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+array<int, 2> Piece::requiredMovesByParity() const
+{
+	array<int, 2> requiredMoves = {{ Infinity, Infinity }};
+
+	/* -- Parity is left unconstrained for pieces whose moves are not fully known -- */
+
+	if (!m_glyph || maybe(m_promoted) || is(m_promoted))
+	{
+		for (int parity : { 0, 1 })
+			requiredMoves[parity] = m_requiredMoves + ((m_requiredMoves + parity) % 2);
+
+		return requiredMoves;
+	}
+
+	/* -- Walk the move graph, keeping squares reached after an odd and an even number of moves apart -- */
+
+	array<Squares, 2> visited;
+	visited[0] = Squares(m_initialSquare);
+	if (m_castlingSquare != Nowhere)
+		visited[0].set(m_castlingSquare);
+
+	Squares squares = visited[0];
+	for (int moves = 0; squares && (moves <= m_availableMoves); moves++)
+	{
+		const int parity = moves % 2;
+
+		if ((squares & m_possibleSquares) && (requiredMoves[parity] >= Infinity))
+			requiredMoves[parity] = std::max(moves, m_requiredMoves + ((m_requiredMoves + parity) % 2));
+
+		if ((requiredMoves[0] < Infinity) && (requiredMoves[1] < Infinity))
+			break;
+
+		squares = successors(m_moves, squares) - visited[!parity];
+		visited[!parity] |= squares;
+	}
+
+	/* -- Done -- */
+
+	for (int parity : { 0, 1 })
+		if (requiredMoves[parity] > m_availableMoves)
+			requiredMoves[parity] = Infinity;
+
+	return requiredMoves;
+}
+
+/* -------------------------------------------------------------------------- */
+
 const Action& Piece::action(Square from, Square to) const
 {
 	assert(m_actions);
@@ -576,9 +781,10 @@ const Action& Piece::action(Square from, Square to) const
 
 /* -------------------------------------------------------------------------- */
 
-const Consequences& Piece::consequences(Square from, Square to) const
+Impacts Piece::consequences(Square from, Square to) const
 {
-	return action(from, to).consequences();
+	assert(m_actions);
+	return m_actions->impacts(from, to);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -633,36 +839,32 @@ void Piece::unfold()
 	xstd::maximize(m_requiredMoves, xstd::min(ValidSquares(m_possibleSquares), [&](Square square) { return m_distances[square]; }));
 	xstd::maximize(m_requiredCaptures, xstd::min(ValidSquares(m_possibleSquares), [&](Square square) { return m_captures[square]; }));
 
-	/* -- Remove moves that will obviously never be played -- */
+	/* -- Remove moves that will obviously never be played, keeping destinations close enough to the final squares -- */
 
 	for (Square from : AllSquares())
-		for (Square to : ValidSquares(m_moves[from]))
-			if (m_distances[from] + 1 + m_rdistances[to] > m_availableMoves)
-				m_moves[from][to] = false;
+		if (m_moves[from])
+			m_moves[from] &= Squares(Kernels::atmost(m_rdistances.data(), m_availableMoves - m_distances[from] - 1));
 
 	if (m_xmoves)
 		for (Square from : AllSquares())
-			for (Square to : ValidSquares(m_moves[from]))
-				if (m_captures[from] + (*m_xmoves)[from][to] + m_rcaptures[to] > m_availableCaptures)
-					m_moves[from][to] = false;
+			if (m_moves[from])
+				m_moves[from] &= (Squares(Kernels::atmost(m_rcaptures.data(), m_availableCaptures - m_captures[from])) - (*m_xmoves)[from]) | (Squares(Kernels::atmost(m_rcaptures.data(), m_availableCaptures - m_captures[from] - 1)) & (*m_xmoves)[from]);
 
 	if (is(m_promoted))
 		for (Square from : AllSquares())
-			for (Square to : ValidSquares(m_pawn.moves[from]))
-				if (m_pawn.distances[from] + 1 + m_pawn.rdistances[to] > m_availableMoves)
-					m_pawn.moves[from][to] = false;
+			if (m_pawn.moves[from])
+				m_pawn.moves[from] &= Squares(Kernels::atmost(m_pawn.rdistances.data(), m_availableMoves - m_pawn.distances[from] - 1));
 
 	if (m_pawn.xmoves)
 		for (Square from : AllSquares())
-			for (Square to : ValidSquares(m_pawn.moves[from]))
-				if (m_pawn.captures[from] + (*m_pawn.xmoves)[from][to] + m_pawn.rcaptures[to] > m_availableCaptures)
-					m_pawn.moves[from][to] = false;
+			if (m_pawn.moves[from])
+				m_pawn.moves[from] &= (Squares(Kernels::atmost(m_pawn.rcaptures.data(), m_availableCaptures - m_pawn.captures[from])) - (*m_pawn.xmoves)[from]) | (Squares(Kernels::atmost(m_pawn.rcaptures.data(), m_availableCaptures - m_pawn.captures[from] - 1)) & (*m_pawn.xmoves)[from]);
 
 	/* -- Update number of possible moves -- */
 
-	m_nmoves = xstd::sum(m_moves, [](const Squares& squares) { return squares.count(); });
+	m_nmoves = Kernels::count(Kernels::words(m_moves));
 	if (is(m_promoted))
-		m_nmoves += xstd::sum(m_pawn.moves, [](const Squares& squares) { return squares.count(); });
+		m_nmoves += Kernels::count(Kernels::words(m_pawn.moves));
 
 	/* -- Update castling state according to corresponding king moves -- */
 
@@ -687,14 +889,14 @@ void Piece::unfold()
 	m_stops = Squares(m_initialSquare);
 	if (m_castlingSquare != Nowhere)
 		m_stops.set(m_castlingSquare);
-	m_stops = xstd::merge(m_moves, m_stops);
+	m_stops |= Kernels::merge(Kernels::words(m_moves), ~uint64_t(0));
 	if (is(m_promoted))
-		m_stops = xstd::merge(m_pawn.moves, m_stops);
+		m_stops |= Kernels::merge(Kernels::words(m_pawn.moves), ~uint64_t(0));
 
 	m_route = m_stops;
 	for (Square from : AllSquares())
-		for (Square to : ValidSquares(m_moves[from]))
-			m_route |= (*m_constraints)[from][to];
+		if (m_moves[from])
+			m_route |= Kernels::merge(Kernels::words((*m_constraints)[from]), m_moves[from]);
 
 	m_threats.reset();
 	for (Square square : ValidSquares(m_stops))
@@ -717,28 +919,6 @@ void Piece::unfold()
 
 		m_possibleCaptures &= captures;
 	}
-
-	/* -- Update occupied squares -- */
-
-	for (Square square : AllSquares())
-	{
-		for (bool loop = true; loop; )
-		{
-			loop = false;
-			for (Square occupied : ValidSquares(m_occupied[square].squares))
-			{
-				for (Square other : ValidSquares(m_occupied[square].pieces[occupied]->m_occupied[occupied].squares))
-				{
-					if (!m_occupied[square].squares[other])
-					{
-						m_occupied[square].pieces[other] = m_occupied[square].pieces[occupied]->m_occupied[occupied].pieces[other];
-						m_occupied[square].squares[other] = true;
-						loop = true;
-					}
-				}
-			}
-		}
-	}
 }
 
 /* -------------------------------------------------------------------------- */
@@ -751,22 +931,22 @@ void Piece::summarize()
 
 	m_distances.fill(Infinity);
 	for (const Piece& personality : m_personalities)
-		xstd::minimize(m_distances, personality.m_distances);
+		Kernels::minimize(m_distances.data(), personality.m_distances.data());
 
 	m_captures.fill(Infinity);
 	for (const Piece& personality : m_personalities)
-		xstd::minimize(m_captures, personality.m_captures);
+		Kernels::minimize(m_captures.data(), personality.m_captures.data());
 
 	m_possibleSquares = xstd::merge(m_personalities, Squares(), [](const Piece& piece) { return piece.m_possibleSquares; });
 	m_possibleCaptures = xstd::merge(m_personalities, Squares(), [](const Piece& piece) { return piece.m_possibleCaptures; });
 
 	m_rdistances.fill(Infinity);
 	for (const Piece& personality : m_personalities)
-		xstd::minimize(m_rdistances, personality.m_rdistances);
+		Kernels::minimize(m_rdistances.data(), personality.m_rdistances.data());
 
 	m_rcaptures.fill(Infinity);
 	for (const Piece& personality : m_personalities)
-		xstd::minimize(m_rcaptures, personality.m_rcaptures);
+		Kernels::minimize(m_rcaptures.data(), personality.m_rcaptures.data());
 
 	/* -- Update possible promotion squares -- */
 
@@ -792,7 +972,7 @@ void Piece::summarize()
 	if (m_glyphs.count() == 1)
 	{
 		assert(m_personalities.size() == 1);
-		std::list<Piece> personalities(std::move(m_personalities));
+		Personalities personalities(std::move(m_personalities));
 		*this = personalities.front();
 
 		m_pieces[m_glyph] = this;
@@ -822,38 +1002,16 @@ void Piece::summarize()
 
 	/* -- Update number of possible moves -- */
 
-	m_nmoves = xstd::sum(m_moves, [](Squares squares) { return squares.count(); });
+	m_nmoves = Kernels::count(Kernels::words(m_moves));
 	for (const Piece& piece : m_personalities)
 		if (!is(piece.m_promoted))
-			m_nmoves += xstd::sum(piece.m_moves, [](Squares squares) { return squares.count(); });
+			m_nmoves += Kernels::count(Kernels::words(piece.m_moves));
 
 	/* -- Get all squares the piece may have crossed or stopped on -- */
 
 	m_stops = xstd::merge(m_personalities, Squares(), [](const Piece& piece) { return piece.m_stops; });
 	m_route = xstd::merge(m_personalities, Squares(), [](const Piece& piece) { return piece.m_route; });
 	m_threats = xstd::merge(m_personalities, Squares(), [](const Piece& piece) { return piece.m_threats; });
-
-	/* -- Update occupied squares -- */
-
-	for (Square square : AllSquares())
-	{
-		for (bool loop = true; loop; )
-		{
-			loop = false;
-			for (Square occupied : ValidSquares(m_occupied[square].squares))
-			{
-				for (Square other : ValidSquares(m_occupied[square].pieces[occupied]->m_occupied[occupied].squares))
-				{
-					if (!m_occupied[square].squares[other])
-					{
-						m_occupied[square].pieces[other] = m_occupied[square].pieces[occupied]->m_occupied[occupied].pieces[other];
-						m_occupied[square].squares[other] = true;
-						loop = true;
-					}
-				}
-			}
-		}
-	}
 }
 
 /* -------------------------------------------------------------------------- */
@@ -862,14 +1020,17 @@ void Piece::updateDistances()
 {
 	if (is(m_promoted))
 	{
-		m_pawn.distances = computeDistances(m_initialSquare, Nowhere, true);
-		xstd::maximize(m_distances, computeDistances(m_promotionSquares, m_pawn.distances));
+		m_pawn.distances = SharedDistancesCache::distances(m_pawn.legalMoves, m_pawn.moves, Squares(m_initialSquare), [&]() { return computeDistances(m_initialSquare, Nowhere, true); });
+		Kernels::maximize(m_distances.data(), computeDistances(m_promotionSquares, m_pawn.distances).data());
 	}
 	else
 	{
 		const bool castling = (m_castlingSquare != Nowhere) && xstd::any_of(AllCastlingSides(), [&](CastlingSide side) { return is(m_castling[side]); });
-		const auto distances = computeDistances(castling ? m_castlingSquare : m_initialSquare, castling ? Nowhere : m_castlingSquare, false);
-		xstd::maximize(m_distances, distances);
+		const Square initial = castling ? m_castlingSquare : m_initialSquare;
+		const Square other = castling ? Nowhere : m_castlingSquare;
+
+		const auto& distances = SharedDistancesCache::distances(m_legalMoves, m_moves, Squares(initial) | ((other != Nowhere) ? Squares(other) : Squares()), [&]() { return computeDistances(initial, other, false); });
+		Kernels::maximize(m_distances.data(), distances.data());
 	}
 }
 
@@ -889,15 +1050,18 @@ void Piece::updateCaptures()
 	if (is(m_promoted))
 	{
 		if (m_pawn.xmoves)
-			xstd::maximize(m_pawn.captures, computeCaptures(m_initialSquare, Nowhere, true));
-		xstd::maximize(m_captures, computeCaptures(m_promotionSquares, m_pawn.captures));
+			Kernels::maximize(m_pawn.captures.data(), SharedDistancesCache::captures(m_pawn.legalMoves, m_pawn.moves, m_pawn.xmoves, Squares(m_initialSquare), [&]() { return computeCaptures(m_initialSquare, Nowhere, true); }).data());
+		Kernels::maximize(m_captures.data(), computeCaptures(m_promotionSquares, m_pawn.captures).data());
 	}
 	else
 	if (m_xmoves)
 	{
 		const bool castling = (m_castlingSquare != Nowhere) && xstd::any_of(AllCastlingSides(), [&](CastlingSide side) { return is(m_castling[side]); });
-		const auto captures = computeCaptures(castling ? m_castlingSquare : m_initialSquare, castling ? Nowhere : m_castlingSquare, false);
-		xstd::maximize(m_captures, captures);
+		const Square initial = castling ? m_castlingSquare : m_initialSquare;
+		const Square other = castling ? Nowhere : m_castlingSquare;
+
+		const auto& captures = SharedDistancesCache::captures(m_legalMoves, m_moves, m_xmoves, Squares(initial) | ((other != Nowhere) ? Squares(other) : Squares()), [&]() { return computeCaptures(initial, other, false); });
+		Kernels::maximize(m_captures.data(), captures.data());
 	}
 }
 
@@ -955,48 +1119,62 @@ void Piece::updateConsequences()
 
 /* -------------------------------------------------------------------------- */
 
-array<int, NumSquares> Piece::computeDistances(Square initial, Square castling, bool pawn) const
+Squares Piece::obstructions(const ArrayOfSquares& constraints, Square from, Squares obstacles)
 {
-	/* -- Initialize distances -- */
+	/* -- Moves from given square that can not avoid all obstacles, tested in a single pass over the constraint row -- */
 
-	array<int, NumSquares> distances;
-	distances.fill(Infinity);
-	distances[initial] = 0;
-	if (castling != Nowhere)
-		distances[castling] = 0;
+	static_assert(sizeof(Squares) == sizeof(uint64_t));
+	return Kernels::supersets(reinterpret_cast<const uint64_t *>(constraints.data()), obstacles - from);
+}
 
-	/* -- Initialized square queue -- */
+/* -------------------------------------------------------------------------- */
 
-	Queue<Square, NumSquares> queue;
-	queue.push(initial);
-	if (castling != Nowhere)
-		queue.push(castling);
+Squares Piece::successors(const ArrayOfSquares& moves, Squares squares)
+{
+	Squares successors;
+	for (Square from : ValidSquares(squares))
+		successors |= moves[from];
 
-	/* -- Loop until every reachable square has been handled -- */
+	return successors;
+}
 
-	const ArrayOfSquares& moves = pawn ? m_pawn.moves : m_moves;
+/* -------------------------------------------------------------------------- */
 
-	while (!queue.empty())
-	{
-		const Square from = queue.front(); queue.pop();
+Squares Piece::predecessors(const ArrayOfSquares& moves, Squares squares, Squares candidates)
+{
+	Squares predecessors;
+	for (Square from : ValidSquares(candidates))
+		if (moves[from] & squares)
+			predecessors.set(from);
 
-		/* -- Handle every possible immediate destination -- */
+	return predecessors;
+}
 
-		for (Square to : ValidSquares(moves[from]))
-		{
-			/* -- This square may have been attained by a quicker path -- */
+/* -------------------------------------------------------------------------- */
 
-			if (distances[to] < Infinity)
-				continue;
+array<int, NumSquares> Piece::computeDistances(Square initial, Square castling, bool pawn) const
+{
+	/* -- Initialize distances and starting squares -- */
+
+	array<int, NumSquares> distances;
+	distances.fill(Infinity);
+
+	Squares visited(initial);
+	if (castling != Nowhere)
+		visited.set(castling);
 
-			/* -- Set square distance -- */
+	/* -- Expand all squares at the same distance at once, until every reachable square has been handled -- */
 
-			distances[to] = distances[from] + 1;
+	const ArrayOfSquares& moves = pawn ? m_pawn.moves : m_moves;
 
-			/* -- Add it to queue of reachable queue -- */
+	Squares squares = visited;
+	for (int distance = 0; squares; distance++)
+	{
+		for (Square square : ValidSquares(squares))
+			distances[square] = distance;
 
-			queue.push(to);
-		}
+		squares = successors(moves, squares) - visited;
+		visited |= squares;
 	}
 
 	/* -- Done -- */
@@ -1010,42 +1188,28 @@ array<int, NumSquares> Piece::computeDistances(Squares promotions, const array<i
 {
 	assert(is(m_promoted));
 
-	/* -- Initialize distances and square queue -- */
+	/* -- Initialize distances and starting squares -- */
 
 	array<int, NumSquares> distances;
 	distances.fill(Infinity);
 
-	Queue<Square, NumSquares> queue;
-
-	for (Square square : ValidSquares(promotions))
-		if ((distances[square] = initial[square]) < Infinity)
-			queue.push(square);
+	Squares origins([&](Square square) { return initial[square] < Infinity; }, ValidSquares(promotions));
+	Squares visited, squares;
 
-	queue.sort([&](Square lhs, Square rhs) { return distances[lhs] < distances[rhs]; });
+	/* -- Expand all squares at the same distance at once, each promotion square joining in at its own distance -- */
 
-	/* -- Loop until every reachable square has been handled -- */
-
-	while (!queue.empty())
+	for (int distance = 0; squares || origins; distance++)
 	{
-		const Square from = queue.front(); queue.pop();
-
-		/* -- Handle every possible immediate destination -- */
-
-		for (Square to : ValidSquares(m_moves[from]))
-		{
-			/* -- This square may have been attained by a quicker path -- */
+		const Squares starts([&](Square square) { return initial[square] == distance; }, ValidSquares(origins));
+		origins -= starts;
 
-			if (distances[to] < Infinity)
-				continue;
-
-			/* -- Set square distance -- */
+		squares = (squares | starts) - visited;
+		visited |= squares;
 
-			distances[to] = distances[from] + 1;
+		for (Square square : ValidSquares(squares))
+			distances[square] = distance;
 
-			/* -- Add it to queue of reachable queue -- */
-
-			queue.push(to);
-		}
+		squares = successors(m_moves, squares);
 	}
 
 	/* -- Done -- */
@@ -1057,62 +1221,30 @@ array<int, NumSquares> Piece::computeDistances(Squares promotions, const array<i
 
 array<int, NumSquares> Piece::computeDistancesTo(Squares destinations, bool pawn) const
 {
-	/* -- Initialize distances and square queue -- */
+	/* -- Initialize distances and starting squares, handling castling -- */
 
 	array<int, NumSquares> distances;
-	Queue<Square, NumSquares> squares;
-
-	for (Square square : AllSquares())
-		if ((distances[square] = (destinations[square] ? 0 : Infinity)) == 0)
-			squares.push(square);
-
-	/* -- Handle castling -- */
+	distances.fill(Infinity);
 
-	if ((m_castlingSquare != Nowhere) && !distances[m_castlingSquare] && distances[m_initialSquare])
-		if ((distances[m_initialSquare] = 0) == 0)
-			squares.push(m_initialSquare);
+	Squares visited = destinations;
+	if ((m_castlingSquare != Nowhere) && destinations[m_castlingSquare])
+		visited.set(m_initialSquare);
 
-	/* -- Loop until every reachable square has been handled -- */
+	/* -- Expand all squares at the same distance at once, until every reachable square has been handled -- */
 
 	const ArrayOfSquares& moves = pawn ? m_pawn.moves : m_moves;
 
-	while (!squares.empty())
+	Squares squares = visited;
+	for (int distance = 0; squares; distance++)
 	{
-		const Square to = squares.front(); squares.pop();
-
-		/* -- Handle every possible immediate destination -- */
-
-		for (Square from : AllSquares())
-		{
-			/* -- Skip illegal moves -- */
-
-			if (!moves[from][to])
-				continue;
-
-			/* -- This square may have been attained by a quicker path -- */
-
-			if (distances[from] < Infinity)
-				continue;
-
-			/* -- Set square distance -- */
-
-			distances[from] = distances[to] + 1;
+		for (Square square : ValidSquares(squares))
+			distances[square] = distance;
 
-			/* -- Add it to queue of reachable squares -- */
+		squares = predecessors(moves, squares, ~visited);
+		if ((m_castlingSquare != Nowhere) && squares[m_castlingSquare] && !visited[m_initialSquare])
+			squares.set(m_initialSquare);
 
-			squares.push(from);
-
-			/* -- Handle castling -- */
-
-			if (from == m_castlingSquare)
-			{
-				if (distances[m_initialSquare] < Infinity)
-					continue;
-
-				distances[m_initialSquare] = distances[m_castlingSquare];
-				squares.push(m_initialSquare);
-			}
-		}
+		visited |= squares;
 	}
 
 	/* -- Done -- */
@@ -1124,45 +1256,28 @@ array<int, NumSquares> Piece::computeDistancesTo(Squares destinations, bool pawn
 
 array<int, NumSquares> Piece::computeDistancesTo(Squares promotions, const array<int, NumSquares>& initial) const
 {
-	/* -- Initialize distances and square queue -- */
+	/* -- Initialize distances and starting squares -- */
 
 	array<int, NumSquares> distances;
-	Queue<Square, NumSquares> squares;
-
-	for (Square square : AllSquares())
-		if ((distances[square] = (promotions[square] ? initial[square] : Infinity)) < Infinity)
-			squares.push(square);
+	distances.fill(Infinity);
 
-	squares.sort([&](Square lhs, Square rhs) { return distances[lhs] < distances[rhs]; });
+	Squares origins([&](Square square) { return initial[square] < Infinity; }, ValidSquares(promotions));
+	Squares visited, squares;
 
-	/* -- Loop until every reachable square has been handled -- */
+	/* -- Expand all squares at the same distance at once, each promotion square joining in at its own distance -- */
 
-	while (!squares.empty())
+	for (int distance = 0; squares || origins; distance++)
 	{
-		const Square to = squares.front(); squares.pop();
-
-		/* -- Handle every possible immediate destination -- */
-
-		for (Square from : AllSquares())
-		{
-			/* -- Skip illegal moves -- */
-
-			if (!m_pawn.moves[from][to])
-				continue;
+		const Squares starts([&](Square square) { return initial[square] == distance; }, ValidSquares(origins));
+		origins -= starts;
 
-			/* -- This square may have been attained by a quicker path -- */
+		squares = (squares | starts) - visited;
+		visited |= squares;
 
-			if (distances[from] < Infinity)
-				continue;
-
-			/* -- Set square distance -- */
-
-			distances[from] = distances[to] + 1;
-
-			/* -- Add it to queue of reachable squares -- */
+		for (Square square : ValidSquares(squares))
+			distances[square] = distance;
 
-			squares.push(from);
-		}
+		squares = predecessors(m_pawn.moves, squares, ~visited);
 	}
 
 	/* -- Done -- */
@@ -1181,139 +1296,99 @@ array<int, NumSquares> Piece::computeDistancesTo(Squares destinations, const Pie
 	if (&blocker == this)
 		return computeDistancesTo(destinations, false);
 
-	/* -- Initialize distances and square queue -- */
-
-	array<int, NumSquares> distances;
-	Queue<Square, NumSquares> squares;
-
-	for (Square square : AllSquares())
-		if ((distances[square] = (destinations[square] && (square != obstruction)) ? 0 : Infinity) == 0)
-			squares.push(square);
-
-	if ((m_castlingSquare != Nowhere) && !distances[m_castlingSquare] && distances[m_initialSquare])
-		if (!(*m_constraints)[m_initialSquare][m_castlingSquare][obstruction])
-			if ((distances[m_initialSquare] = 0) == 0)
-				squares.push(m_initialSquare);
+	/* -- Mask moves obstructed by the blocker, or that would bring us or the enemy king into check -- */
 
-	/* -- Loop until every reachable square has been handled -- */
+	const Squares checks = (m_royal && enemies) ? (*blocker.m_checks)[obstruction] : Squares();
 
-	while (!squares.empty())
+	ArrayOfSquares moves;
+	for (Square from : AllSquares())
 	{
-		const Square to = squares.front(); squares.pop();
+		moves[from] = Squares();
 
-		/* -- Handle every possible immediate destination -- */
+		if (from == obstruction)
+			continue;
 
-		for (Square from : AllSquares())
-		{
-			/* -- Skip illegal moves -- */
+		if (blocker.m_royal && enemies && (*m_checks)[from][obstruction])
+			continue;
 
-			if (!m_moves[from][to])
-				continue;
+		for (Square to : ValidSquares(m_moves[from] - checks))
+			if (!(*m_constraints)[from][to][obstruction])
+				moves[from].set(to);
+	}
 
-			/* -- Skip obstructed moves -- */
+	const bool castling = (m_castlingSquare != Nowhere) && !(*m_constraints)[m_initialSquare][m_castlingSquare][obstruction];
 
-			if (obstruction == from)
-				continue;
+	/* -- Initialize distances and starting squares, handling castling -- */
 
-			if ((*m_constraints)[from][to][obstruction])
-				continue;
+	array<int, NumSquares> distances;
+	distances.fill(Infinity);
 
-			if (m_royal && enemies)
-				if ((*blocker.m_checks)[obstruction][to])
-					continue;
+	Squares visited = destinations - obstruction;
+	if (castling && visited[m_castlingSquare])
+		visited.set(m_initialSquare);
 
-			if (blocker.m_royal && enemies)
-				if ((*m_checks)[from][obstruction])
-					continue;
+	/* -- Expand all squares at the same distance at once, until every reachable square has been handled -- */
 
-			/* -- This square may have been attained by a quicker path -- */
+	Squares squares = visited;
+	for (int distance = 0; squares; distance++)
+	{
+		for (Square square : ValidSquares(squares))
+			distances[square] = distance;
 
-			if (distances[from] < Infinity)
-				continue;
+		squares = predecessors(moves, squares, ~visited);
+		if (castling && squares[m_castlingSquare] && !visited[m_initialSquare])
+			squares.set(m_initialSquare);
 
-			/* -- Set square distance -- */
+		visited |= squares;
+	}
 
-			distances[from] = distances[to] + 1;
+	/* -- Done -- */
 
-			/* -- Add it to queue of reachable squares -- */
+	return distances;
+}
 
-			squares.push(from);
+/* -------------------------------------------------------------------------- */
 
-			/* -- Handle castling -- */
+array<int, NumSquares> Piece::computeCaptures(Square initial, Square castling, bool pawn) const
+{
+	/* -- Split moves between those that may be performed without capturing and captures -- */
 
-			if (from == m_castlingSquare)
-			{
-				if (distances[m_initialSquare] < Infinity)
-					continue;
-
-				if ((*m_constraints)[m_initialSquare][m_castlingSquare][obstruction])
-					continue;
+	const ArrayOfSquares& moves = pawn ? m_pawn.moves : m_moves;
+	const ArrayOfSquares *xmoves = pawn ? m_pawn.xmoves : m_xmoves;
 
-				distances[m_initialSquare] = distances[m_castlingSquare];
-				squares.push(m_initialSquare);
-			}
-		}
+	ArrayOfSquares quiet, xquiet;
+	for (Square square : AllSquares())
+	{
+		quiet[square] = xmoves ? moves[square] - (*xmoves)[square] : moves[square];
+		xquiet[square] = moves[square] - quiet[square];
 	}
 
-	/* -- Done -- */
-
-	return distances;
-}
-
-/* -------------------------------------------------------------------------- */
-
-array<int, NumSquares> Piece::computeCaptures(Square initial, Square castling, bool pawn) const
-{
-	/* -- Initialize required captures -- */
+	/* -- Initialize required captures and starting squares -- */
 
 	array<int, NumSquares> captures;
 	captures.fill(Infinity);
-	captures[initial] = 0;
-	if (castling != Nowhere)
-		captures[castling] = 0;
-
-	/* -- Initialize squares to process -- */
 
-	Squares candidates(initial);
+	Squares visited(initial);
 	if (castling != Nowhere)
-		candidates.set(castling);
-
-	/* -- Loop until every reachable square has been handled, by order of number of captures -- */
+		visited.set(castling);
 
-	const ArrayOfSquares& moves = pawn ? m_pawn.moves : m_moves;
-	const ArrayOfSquares *xmoves = pawn ? m_pawn.xmoves : m_xmoves;
+	/* -- Expand all squares requiring the same number of captures at once, by order of number of captures -- */
 
-	while (candidates)
+	Squares squares = visited;
+	for (int required = 0; squares; required++)
 	{
-		Squares squares = candidates;
-		candidates.reset();
-
-		while (squares)
+		for (Squares frontier = squares; frontier; )
 		{
-			const Square from = squares.pop();
-
-			/* -- Handle every possible immediate destination -- */
-
-			for (Square to : ValidSquares(moves[from]))
-			{
-				/* -- This square may have been attained using less captures -- */
-
-				const int required = captures[from] + (xmoves && (*xmoves)[from][to]);
-				if (required >= captures[to])
-					continue;
-
-				/* -- Set required captures -- */
-
-				captures[to] = required;
+			frontier = successors(quiet, frontier) - visited;
+			visited |= frontier;
+			squares |= frontier;
+		}
 
-				/* -- Add it to queue of squares -- */
+		for (Square square : ValidSquares(squares))
+			captures[square] = required;
 
-				if (captures[to] > captures[from])
-					candidates.set(to);
-				else
-					squares.set(to);
-			}
-		}
+		squares = successors(xquiet, squares) - visited;
+		visited |= squares;
 	}
 
 	/* -- Done -- */
@@ -1325,40 +1400,36 @@ array<int, NumSquares> Piece::computeCaptures(Square initial, Square castling, b
 
 array<int, NumSquares> Piece::computeCaptures(Squares promotions, const array<int, NumSquares>& initial) const
 {
-	/* -- Initialize required captures and square queue -- */
+	assert(!m_xmoves);
+
+	/* -- Initialize required captures and starting squares -- */
 
 	array<int, NumSquares> captures;
 	captures.fill(Infinity);
 
-	Queue<Square, NumSquares> queue;
+	Squares origins([&](Square square) { return initial[square] < Infinity; }, ValidSquares(promotions));
+	Squares visited;
 
-	for (Square square : ValidSquares(promotions))
-		if ((captures[square] = initial[square]) < Infinity)
-			queue.push(square);
+	/* -- Flood fill required captures, by order of number of captures -- */
 
-	queue.sort([&](Square lhs, Square rhs) { return captures[lhs] < captures[rhs]; });
-
-	/* -- Flood fill required captures -- */
-
-	assert(!m_xmoves);
-
-	while (!queue.empty())
+	while (origins)
 	{
-		Squares squares = queue.front(); queue.pop();
+		const int required = xstd::min(ValidSquares(origins), [&](Square square) { return initial[square]; });
+		const Squares starts([&](Square square) { return initial[square] == required; }, ValidSquares(origins));
+		origins -= starts;
 
-		while (squares)
-		{
-			Square from = squares.pop();
+		Squares squares = starts - visited;
+		visited |= squares;
 
-			for (Square to : ValidSquares(m_moves[from]))
-			{
-				if (captures[to] > captures[from])
-				{
-					captures[to] = captures[from];
-					squares.set(to);
-				}
-			}
+		for (Squares frontier = squares; frontier; )
+		{
+			frontier = successors(m_moves, frontier) - visited;
+			visited |= frontier;
+			squares |= frontier;
 		}
+
+		for (Square square : ValidSquares(squares))
+			captures[square] = required;
 	}
 
 	/* -- Done -- */
@@ -1372,49 +1443,42 @@ array<int, NumSquares> Piece::computeCapturesTo(Squares destinations, bool pawn)
 {
 	assert(pawn ? m_pawn.xmoves : m_xmoves);
 
-	/* -- Initialize captures and square queue -- */
-
-	array<int, NumSquares> captures;
-	Queue<Square, 8 * NumSquares> squares;
-
-	captures.fill(Infinity);
-
-	for (Square square : AllSquares())
-		if ((captures[square] = destinations[square] ? 0 : Infinity) < Infinity)
-			squares.push(square);
-
-	/* -- Loop until every reachable square has been handled -- */
+	/* -- Split moves between those that may be performed without capturing and captures -- */
 
 	const ArrayOfSquares& moves = pawn ? m_pawn.moves : m_moves;
-	const ArrayOfSquares *xmoves = pawn ? m_pawn.xmoves : m_xmoves;
+	const ArrayOfSquares& xmoves = pawn ? *m_pawn.xmoves : *m_xmoves;
 
-	while (!squares.empty())
+	ArrayOfSquares quiet, xquiet;
+	for (Square square : AllSquares())
 	{
-		const Square to = squares.front(); squares.pop();
-
-		/* -- Handle every possible immediate destination -- */
-
-		for (Square from : AllSquares())
-		{
-			/* -- Skip illegal moves -- */
+		quiet[square] = moves[square] - xmoves[square];
+		xquiet[square] = moves[square] & xmoves[square];
+	}
 
-			if (!moves[from][to])
-				continue;
+	/* -- Initialize required captures and starting squares -- */
 
-			/* -- This square may have been attained using less captures -- */
+	array<int, NumSquares> captures;
+	captures.fill(Infinity);
 
-			const int required = captures[to] + (*xmoves)[from][to];
-			if (required >= captures[from])
-				continue;
+	Squares visited = destinations;
 
-			/* -- Set square required number of captures -- */
+	/* -- Expand all squares requiring the same number of captures at once, by order of number of captures -- */
 
-			captures[from] = required;
+	Squares squares = visited;
+	for (int required = 0; squares; required++)
+	{
+		for (Squares frontier = squares; frontier; )
+		{
+			frontier = predecessors(quiet, frontier, ~visited);
+			visited |= frontier;
+			squares |= frontier;
+		}
 
-			/* -- Add it to queue of reachable squares -- */
+		for (Square square : ValidSquares(squares))
+			captures[square] = required;
 
-			squares.push(from);
-		}
+		squares = predecessors(xquiet, squares, ~visited);
+		visited |= squares;
 	}
 
 	/* -- Done -- */
@@ -1434,8 +1498,17 @@ int Piece::fastplay(array<State, 2>& states, int availableMoves)
 
 int Piece::fullplay(array<State, 2>& states, int availableMoves)
 {
-	TwoPieceCache cache;
-	return fullplay(states, availableMoves, availableMoves, cache);
+	TwoPieceLayers positions(std::min(states[0].availableMoves, availableMoves), std::min(states[1].availableMoves, availableMoves));
+	TwoPieceLayers solutions(std::min(states[0].availableMoves, availableMoves), std::min(states[1].availableMoves, availableMoves));
+	return fullplay(states, availableMoves, positions, solutions);
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Piece::fullplay(array<State, 3>& states, int availableMoves)
+{
+	ThreePieceLayers positions(std::min(states[0].availableMoves, availableMoves), std::min(states[1].availableMoves, availableMoves), std::min(states[2].availableMoves, availableMoves));
+	return fullplay(states, availableMoves, positions);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -1592,166 +1665,660 @@ int Piece::fastplay(array<State, 2>& states, int availableMoves, TwoPieceFastCac
 
 /* -------------------------------------------------------------------------- */
 
-int Piece::fullplay(array<State, 2>& states, int availableMoves, int maximumMoves, TwoPieceCache& cache)
+Piece::Movements Piece::movements(const Stage& stage) const
+{
+	/* -- Promoted pieces move as pawns until their promotion -- */
+
+	if (is(m_promoted) && !stage.promoted)
+		return Movements(m_pawn.moves, *m_pawn.constraints, *m_pawn.checks, m_pawn.rdistances);
+
+	return Movements(m_moves, *m_constraints, *m_checks, m_rdistances);
+}
+
+/* -------------------------------------------------------------------------- */
+
+Squares Piece::goals(const Stage& stage) const
 {
+	/* -- All required squares must have been visited -- */
+
+	if (stage.visits != m_visits)
+		return Squares();
+
+	/* -- A captured piece has reached its goal, wherever it lies -- */
+
+	if (stage.captured)
+		return Squares().set();
+
+	/* -- Otherwise the piece must lie on one of its possible squares -- */
+
+	if (is(m_captured) || (is(m_promoted) && !stage.promoted))
+		return Squares();
+
+	return m_possibleSquares;
+}
+
+/* -------------------------------------------------------------------------- */
+
+bool Piece::blocked(const Piece& piece, const Movements& movements, Square from, Square to, const Piece& xpiece, const Movements& xmovements, Square other)
+{
+	/* -- Move could be blocked by other pieces -- */
+
+	if (movements.constraints[from][to][other] || xpiece.m_occupied[other].squares[from])
+		return true;
+
+	for (Square square : ValidSquares(xpiece.m_occupied[other].squares))
+		if (movements.constraints[from][to][square])
+			return true;
+
+	/* -- We may not move into check -- */
+
+	if (piece.m_royal && (piece.m_color != xpiece.m_color) && xmovements.checks[other][to])
+		return true;
+
+	return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+template <typename Function>
+void Piece::transit(const array<State, 2>& states, int k, const array<Square, 2>& squares, const array<Stage, 2>& stages, const array<int, 2>& moves, const Function& function)
+{
+	const State& state = states[k];
+	const Piece& piece = state.piece;
+	const Piece& xpiece = states[k ^ 1].piece;
+	const Stage& stage = stages[k];
+	const Square from = squares[k];
+	const Square other = squares[k ^ 1];
+	const bool friends = (piece.m_color == xpiece.m_color);
+	const bool present = !stages[k ^ 1].captured;
+
+	/* -- Nothing happens anymore to captured pieces -- */
+
+	if (stage.captured)
+		return;
+
+	/* -- Teleportation of a rook that has not yet moved, when castling -- */
+
+	if (state.teleportation && !moves[k] && (from == piece.m_initialSquare))
+	{
+		const Square king = (xpiece.m_royal && friends) ? other : Nowhere;
+		const Square pivot = std::find_if(Castlings[piece.m_color], Castlings[piece.m_color] + NumCastlingSides, [=](const Castling& castling) { return castling.rook == from; })->to;
+
+		if ((king != Nowhere) ? (king == pivot) && (moves[k ^ 1] == 1) : !present || !(*piece.m_constraints)[from][piece.m_castlingSquare][other])
+			function(piece.m_castlingSquare, stage);
+	}
+
+	/* -- Promotion of a pawn that has reached the last rank -- */
+
+	if (is(piece.m_promoted) && !stage.promoted && piece.m_promotionSquares[from])
+	{
+		Stage promoted = stage;
+		promoted.promoted = true;
+		function(from, promoted);
+	}
+
+	/* -- Capture on one of the possible squares, after promotion for promoted pieces -- */
+
+	if (maybe(piece.m_captured) && (stage.promoted || !is(piece.m_promoted)) && piece.m_possibleSquares[from])
+	{
+		Stage captured = stage;
+		captured.captured = true;
+		function(from, captured);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+template <typename Function>
+void Piece::play(const array<State, 2>& states, int k, const array<Square, 2>& squares, const array<Stage, 2>& stages, const array<int, 2>& moves, int availableMoves, const Function& function)
+{
+	const State& state = states[k];
+	const Piece& piece = state.piece;
+	const Piece& xpiece = states[k ^ 1].piece;
+	const Movements movements = piece.movements(stages[k]);
+	const Movements xmovements = xpiece.movements(stages[k ^ 1]);
+	const Square from = squares[k];
+	const Square other = squares[k ^ 1];
+	const bool friends = (piece.m_color == xpiece.m_color);
+	const bool present = !stages[k ^ 1].captured;
+
+	/* -- Captured pieces do not move anymore -- */
+
+	if (stages[k].captured)
+		return;
+
+	/* -- Check if there are any moves left for this piece -- */
+
+	if (moves[k] >= state.availableMoves)
+		return;
+
+	/* -- Check that the enemy is not in check -- */
+
+	if (present && xpiece.m_royal && !friends && movements.checks[from][other])
+		return;
+
+	/* -- Loop over all moves -- */
+
+	for (Square to : ValidSquares(movements.moves[from]))
+	{
+		/* -- Move could be blocked by other piece, or bring us into check -- */
+
+		if (present && blocked(piece, movements, from, to, xpiece, xmovements, other))
+			continue;
+
+		/* -- Reject move if it brings us to far away -- */
+
+		if (1 + movements.rdistances[to] > std::min(availableMoves, state.availableMoves - moves[k]))
+			continue;
+
+		/* -- Castling constraints -- */
+
+		bool castling = true;
+		if (piece.m_royal && (from == piece.m_initialSquare))
+			for (CastlingSide side : AllCastlingSides())
+				if ((Castlings[piece.m_color][side].from == from) && (Castlings[piece.m_color][side].to == to))
+					if (moves[k] || (present && !friends && (xmovements.checks[other][from] || xmovements.checks[other][Castlings[piece.m_color][side].free])))
+						castling = false;
+
+		if (!castling)
+			continue;
+
+		/* -- Play move -- */
+
+		function(to);
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+int Piece::fullplay(array<State, 2>& states, int availableMoves, TwoPieceLayers& positions, TwoPieceLayers& solutions)
+{
+	typedef TwoPieceLayers::Layer Layer;
+	typedef array<Stage, 2> Stages;
+
+	const array<int, 2> maximumMoves = { std::min(states[0].availableMoves, availableMoves), std::min(states[1].availableMoves, availableMoves) };
+	const bool transitions = xstd::any_of(states, [](const State& state) { return state.teleportation || is(state.piece.m_promoted) || maybe(state.piece.m_captured); });
 	int requiredMoves = Infinity;
 
-	/* -- Check if we have achieved our goal -- */
+	/* -- Our goal is reached when both pieces are on possible final squares or captured, after having visited all required squares -- */
+
+	auto goal = [&](const array<Square, 2>& squares, const Stages& stages) {
+		return states[0].piece.goals(stages[0])[squares[0]] && states[1].piece.goals(stages[1])[squares[1]];
+	};
+
+	auto visited = [&](int k, Square to, const Stages& stages) {
+		Stages next = stages;
+		if (states[k].piece.m_visits[to])
+			next[k].visits |= to;
+		return next;
+	};
+
+	/* -- Forward pass: find all positions reachable with a given number of moves for each piece -- */
 
-	if (states[0].piece.m_possibleSquares[states[0].square] && states[1].piece.m_possibleSquares[states[1].square])
+	positions.squares({ 0, 0 }, Stages())[states[0].piece.m_initialSquare][states[1].piece.m_initialSquare] = true;
+
+	for (int moves = 0; moves <= availableMoves; moves++)
 	{
-		if ((states[0].visits == states[0].piece.m_visits) && (states[1].visits == states[1].piece.m_visits))
+		for (int movesA = std::max(0, moves - maximumMoves[1]); movesA <= std::min(moves, maximumMoves[0]); movesA++)
 		{
-			/* -- Get required moves -- */
+			const array<int, 2> played = { movesA, moves - movesA };
 
-			xstd::minimize(states[0].requiredMoves, states[0].playedMoves);
-			xstd::minimize(states[1].requiredMoves, states[1].playedMoves);
-			requiredMoves = states[0].playedMoves + states[1].playedMoves;
+			/* -- Teleportations, promotions and captures do not count as moves and thus stay in the same layer -- */
 
-			/* -- Label occupied squares -- */
+			for (bool transited = transitions; transited; )
+			{
+				transited = false;
 
-			states[0].squares[states[0].square][states[1].square] = true;
-			states[1].squares[states[1].square][states[0].square] = true;
+				for (size_t l = 0; l < positions.layers(played).size(); l++)
+				{
+					const Layer layer = positions.layers(played)[l];
+					for (Square squareA : AllSquares())
+					{
+						for (Square squareB : ValidSquares(layer.squares[squareA]))
+						{
+							for (int k = 0; k < 2; k++)
+							{
+								transit(states, k, { squareA, squareB }, layer.stages, played, [&](Square to, const Stage& stage) {
+									array<Square, 2> next = { squareA, squareB };
+									next[k] = to;
+
+									Stages stages = layer.stages;
+									stages[k] = stage;
+
+									Squares& squares = positions.squares(played, stages)[next[0]];
+									if (!squares[next[1]])
+										squares[next[1]] = true, transited = true;
+								});
+							}
+						}
+					}
+				}
+			}
+
+			/* -- Positions created by actual moves always lie in other layers -- */
+
+			for (Layer& layer : positions.layers(played))
+			{
+				for (Square squareA : AllSquares())
+				{
+					for (Square squareB : ValidSquares(layer.squares[squareA]))
+					{
+						const array<Square, 2> squares = { squareA, squareB };
+
+						/* -- Check if we have reached our goal -- */
+
+						if (goal(squares, layer.stages))
+						{
+							xstd::minimize(states[0].requiredMoves, played[0]);
+							xstd::minimize(states[1].requiredMoves, played[1]);
+							xstd::minimize(requiredMoves, moves);
+						}
+
+						/* -- Add resulting positions to the next layers -- */
+
+						for (int k = 0; k < 2; k++)
+						{
+							play(states, k, squares, layer.stages, played, availableMoves - moves, [&](Square to) {
+								array<Square, 2> next = squares;
+								next[k] = to;
+
+								array<int, 2> playedMoves = played;
+								playedMoves[k] += 1;
+
+								positions.squares(playedMoves, visited(k, to, layer.stages))[next[0]][next[1]] = true;
+							});
+						}
+					}
+				}
+			}
 		}
 	}
 
-	/* -- Break recursion if there are no more moves available -- */
+	/* -- Early exit if our goal can not be reached -- */
 
-	if (availableMoves < 0)
+	if (requiredMoves >= Infinity)
 		return requiredMoves;
 
-	/* -- Check for cache hit -- */
+	/* -- Backward pass: keep positions that lead to our goal, and label the moves and squares used -- */
 
-	if (cache.hit(states[0].square, states[0].playedMoves, states[0].visits, states[1].square, states[1].playedMoves, states[1].visits, &requiredMoves))
-		return requiredMoves;
+	for (int moves = availableMoves; moves >= 0; moves--)
+	{
+		for (int movesA = std::max(0, moves - maximumMoves[1]); movesA <= std::min(moves, maximumMoves[0]); movesA++)
+		{
+			const array<int, 2> played = { movesA, moves - movesA };
+			const std::vector<Layer>& layers = positions.layers(played);
 
-	/* -- Loop over both pieces -- */
+			/* -- Create all solved layers first, so that they are not moved around later on -- */
 
-	for (int k = 0; k < 2; k++)
-	{
-		const int s = k ^ (states[0].playedMoves > states[1].playedMoves);
+			for (const Layer& layer : layers)
+				solutions.squares(played, layer.stages);
 
-		State& state = states[s];
-		State& xstate = states[s ^ 1];
-		const Piece& piece = state.piece;
-		const Piece& xpiece = xstate.piece;
-		const Square from = state.square;
-		const Square other = xstate.square;
-		const bool friends = (piece.m_color == xpiece.m_color);
+			/* -- A position is solved if our goal is reached or if it leads to a solved position -- */
 
-		/* -- Teleportation when castling -- */
+			for (const Layer& layer : layers)
+			{
+				ArrayOfSquares& solved = solutions.squares(played, layer.stages);
 
-		if (state.teleportation && !state.playedMoves)
-		{
-			const Square king = (xpiece.m_royal && friends) ? other : Nowhere;
-			const Square pivot = std::find_if(Castlings[piece.m_color], Castlings[piece.m_color] + NumCastlingSides, [=](const Castling& castling) { return castling.rook == from; })->to;
+				for (Square squareA : AllSquares())
+				{
+					for (Square squareB : ValidSquares(layer.squares[squareA]))
+					{
+						const array<Square, 2> squares = { squareA, squareB };
 
-			if ((king != Nowhere) ? (king == pivot) && (xstate.playedMoves == 1) : !(*piece.m_constraints)[piece.m_initialSquare][piece.m_castlingSquare][other])
+						if (goal(squares, layer.stages))
+							solved[squareA][squareB] = true;
+
+						for (int k = 0; k < 2; k++)
+						{
+							play(states, k, squares, layer.stages, played, availableMoves - moves, [&](Square to) {
+								array<Square, 2> next = squares;
+								next[k] = to;
+
+								array<int, 2> playedMoves = played;
+								playedMoves[k] += 1;
+
+								const ArrayOfSquares *successors = solutions.find(playedMoves, visited(k, to, layer.stages));
+								if (successors && (*successors)[next[0]][next[1]])
+								{
+									State& state = states[k];
+									const bool pawn = is(state.piece.m_promoted) && !layer.stages[k].promoted;
+
+									solved[squareA][squareB] = true;
+									(pawn ? state.pawnMoves : state.moves)[squares[k]][to] = true;
+									if (!pawn)
+										xstd::minimize(state.distances[to], played[k] + 1);
+								}
+							});
+						}
+					}
+				}
+			}
+
+			/* -- Take teleportations, promotions and captures into account -- */
+
+			for (bool transited = transitions; transited; )
 			{
-				assert(!piece.m_distances[piece.m_castlingSquare]);
-				if (!piece.m_distances[piece.m_castlingSquare])
+				transited = false;
+
+				for (const Layer& layer : layers)
 				{
-					state.square = piece.m_castlingSquare;
-					state.teleportation = false;
+					ArrayOfSquares& solved = solutions.squares(played, layer.stages);
 
-					const int myRequiredMoves = fullplay(states, availableMoves, maximumMoves, cache);
-					if (myRequiredMoves <= maximumMoves)
+					for (Square squareA : AllSquares())
 					{
-						state.squares[from][other] = true;
-						xstate.squares[other][from] = true;
-
-						state.distances[piece.m_castlingSquare] = 0;
+						for (Square squareB : ValidSquares(layer.squares[squareA]))
+						{
+							for (int k = 0; k < 2; k++)
+							{
+								transit(states, k, { squareA, squareB }, layer.stages, played, [&](Square to, const Stage& stage) {
+									array<Square, 2> next = { squareA, squareB };
+									next[k] = to;
+
+									Stages stages = layer.stages;
+									stages[k] = stage;
+
+									const ArrayOfSquares *successors = solutions.find(played, stages);
+									if (successors && (*successors)[next[0]][next[1]])
+									{
+										if (!stage.captured)
+											xstd::minimize(states[k].distances[to], played[k]);
+
+										if (!solved[squareA][squareB])
+											solved[squareA][squareB] = true, transited = true;
+									}
+								});
+							}
+						}
 					}
+				}
+			}
+
+			/* -- Label occupied squares, a captured piece occupying none of them -- */
+
+			for (const Layer& layer : layers)
+			{
+				const ArrayOfSquares& solved = solutions.squares(played, layer.stages);
+
+				for (Square squareA : AllSquares())
+				{
+					for (Square squareB : ValidSquares(solved[squareA]))
+					{
+						const array<Square, 2> squares = { squareA, squareB };
 
-					xstd::minimize(requiredMoves, myRequiredMoves);
+						for (int k = 0; k < 2; k++)
+						{
+							if (layer.stages[k].captured)
+								continue;
 
-					state.teleportation = true;
-					state.square = piece.m_initialSquare;
+							if (layer.stages[k ^ 1].captured)
+								states[k].squares[squares[k]].set();
+							else
+								states[k].squares[squares[k]][squares[k ^ 1]] = true;
+						}
+					}
 				}
 			}
 		}
+	}
 
-		/* -- Check if there are any moves left for this piece -- */
+	/* -- Done -- */
 
-		if (state.availableMoves <= 0)
+	return requiredMoves;
+}
+
+/* -------------------------------------------------------------------------- */
+
+template <typename Function>
+void Piece::play(const array<State, 3>& states, const array<ArrayOfSquares, 3>& checks, Squares crowded, int k, const array<Square, 3>& squares, Squares others, const array<int, 3>& moves, int availableMoves, const Function& function)
+{
+	const State& state = states[k];
+	const Piece& piece = state.piece;
+	const Movements movements = piece.movements(Stage());
+	const Square from = squares[k];
+
+	/* -- The first two pieces lie on given squares, the third one on a set of squares, unless it is the one moving -- */
+
+	const int explicits = (k < 2) ? 1 : 2;
+	const array<int, 2> xk = { (k < 2) ? (k ^ 1) : 0, 1 };
+	const Piece& vpiece = states[2].piece;
+
+	/* -- Check if there are any moves left for this piece -- */
+
+	if (moves[k] >= state.availableMoves)
+		return;
+
+	/* -- Check that the enemy is not in check -- */
+
+	for (int x = 0; x < explicits; x++)
+		if (states[xk[x]].piece.m_royal && (piece.m_color != states[xk[x]].piece.m_color) && (*piece.m_checks)[from][squares[xk[x]]])
+			return;
+
+	if ((k < 2) && vpiece.m_royal && (piece.m_color != vpiece.m_color))
+		others -= (*piece.m_checks)[from];
+
+	if (!others)
+		return;
+
+	/* -- Loop over all moves -- */
+
+	for (Square to : ValidSquares(piece.m_moves[from]))
+	{
+		/* -- Reject move if it brings us to far away -- */
+
+		if (1 + piece.m_rdistances[to] > std::min(availableMoves, state.availableMoves - moves[k]))
 			continue;
 
-		/* -- Check that the enemy is not in check -- */
+		/* -- Move could be blocked by other pieces, or bring us into check -- */
+
+		bool obstructed = false;
+		for (int x = 0; x < explicits; x++)
+			if (blocked(piece, movements, from, to, states[xk[x]].piece, states[xk[x]].piece.movements(Stage()), squares[xk[x]]))
+				obstructed = true;
 
-		if (xpiece.m_royal && !friends && (*piece.m_checks)[from][other])
+		if (obstructed)
 			continue;
 
-		/* -- Loop over all moves -- */
+		/* -- Same checks, for all squares of the third piece at once -- */
 
-		for (Square to : ValidSquares(piece.m_moves[from]))
+		Squares squares = others;
+		if (k < 2)
 		{
-			/* -- Move could be blocked by other pieces -- */
+			squares -= (*piece.m_constraints)[from][to];
+			if (piece.m_royal && (piece.m_color != vpiece.m_color))
+				squares -= checks[2][to];
+
+			/* -- Squares on which the third piece implies other occupied squares are checked one by one -- */
 
-			bool blocked = (*piece.m_constraints)[from][to][other] || xpiece.m_occupied[other].squares[from];
-			for (Square square : ValidSquares(xpiece.m_occupied[other].squares))
-				if ((*piece.m_constraints)[from][to][square])
-					blocked = true;
+			for (Square square : ValidSquares(squares & crowded))
+				if (vpiece.m_occupied[square].squares[from] || (vpiece.m_occupied[square].squares & (*piece.m_constraints)[from][to]))
+					squares[square] = false;
 
-			if (blocked)
+			if (!squares)
 				continue;
+		}
 
-			/* -- Reject move if it brings us to far away -- */
+		/* -- Play move -- */
 
-			if (1 + piece.m_rdistances[to] > std::min(availableMoves, state.availableMoves))
-				continue;
+		function(to, squares);
+	}
+}
 
-			/* -- Reject move if we move into check -- */
+/* -------------------------------------------------------------------------- */
 
-			if (piece.m_royal && !friends && (*xpiece.m_checks)[other][to])
-				continue;
+int Piece::fullplay(array<State, 3>& states, int availableMoves, ThreePieceLayers& positions)
+{
+	typedef ThreePieceLayers::Layer Layer;
+	typedef array<Stage, 3> Stages;
 
-			/* -- Castling constraints -- */
+	const array<int, 3> maximumMoves = { std::min(states[0].availableMoves, availableMoves), std::min(states[1].availableMoves, availableMoves), std::min(states[2].availableMoves, availableMoves) };
+	int requiredMoves = Infinity;
 
-			if (piece.m_royal && !friends && (from == piece.m_initialSquare))
-				for (CastlingSide side : AllCastlingSides())
-					if ((Castlings[piece.m_color][side].from == from) && (Castlings[piece.m_color][side].to == to))
-						if (state.playedMoves || (*xpiece.m_checks)[other][from] || (*xpiece.m_checks)[other][Castlings[piece.m_color][side].free])
-							continue;
+	/* -- Limit memory usage, as each layer holds a full matrix of squares -- */
 
-			/* -- Play move -- */
+	const size_t maximumLayers = 1024;
 
-			state.availableMoves -= 1;
-			state.playedMoves += 1;
-			state.square = to;
+	/* -- Squares from which each piece checks a given square -- */
+
+	array<ArrayOfSquares, 3> checks;
+	for (int k = 0; k < 3; k++)
+		for (Square from : AllSquares())
+			for (Square to : ValidSquares((*states[k].piece.m_checks)[from]))
+				checks[k][to] |= from;
 
-			Squares visits = state.visits;
-			if (state.piece.m_visits[to])
-				state.visits |= to;
+	/* -- Squares on which the third piece implies that other squares are occupied -- */
 
-			/* -- Recursion -- */
+	const Squares crowded([&](Square square) { return states[2].piece.m_occupied[square].squares.any(); });
 
-			const int myRequiredMoves = fullplay(states, availableMoves - 1, maximumMoves, cache);
+	/* -- Our goal is reached when all pieces are on possible final squares, after having visited all required squares -- */
 
-			/* -- Cache this position, for tremendous speedups -- */
+	auto goal = [&](const array<Square, 2>& squares, const Stages& stages) -> Squares {
+		if (!states[0].piece.goals(stages[0])[squares[0]] || !states[1].piece.goals(stages[1])[squares[1]])
+			return Squares();
+
+		return states[2].piece.goals(stages[2]);
+	};
+
+	auto visited = [&](int k, Square to, const Stages& stages) {
+		Stages next = stages;
+		if (states[k].piece.m_visits[to])
+			next[k].visits |= to;
+		return next;
+	};
 
-			cache.add(states[0].square, states[0].playedMoves, states[0].visits, states[1].square, states[1].playedMoves, states[1].visits, myRequiredMoves);
+	/* -- Forward pass: find all positions reachable with a given number of moves for each piece -- */
 
-			/* -- Label all valid moves that can be used to reach our goals and squares that were occupied -- */
+	positions.squares({ 0, 0, 0 }, Stages())[states[0].piece.m_initialSquare][states[1].piece.m_initialSquare] |= states[2].piece.m_initialSquare;
 
-			if (myRequiredMoves <= maximumMoves)
+	for (int moves = 0; moves <= availableMoves; moves++)
+	{
+		for (int movesA = 0; movesA <= std::min(moves, maximumMoves[0]); movesA++)
+		{
+			for (int movesB = std::max(0, moves - movesA - maximumMoves[2]); movesB <= std::min(moves - movesA, maximumMoves[1]); movesB++)
 			{
-				state.moves[from][to] = true;
-				state.squares[from][other] = true;
-				xstate.squares[other][from] = true;
+				const array<int, 3> played = { movesA, movesB, moves - movesA - movesB };
+
+				for (Layer& layer : positions.layers(played))
+				{
+					for (Square squareA : AllSquares())
+					{
+						for (Square squareB : AllSquares())
+						{
+							const Squares squaresC = layer.squares[squareA][squareB];
+							if (!squaresC)
+								continue;
+
+							/* -- Check if we have reached our goal -- */
+
+							const Squares goals = squaresC & goal({ squareA, squareB }, layer.stages);
+							if (goals)
+							{
+								for (int k = 0; k < 3; k++)
+									xstd::minimize(states[k].requiredMoves, played[k]);
 
-				xstd::minimize(state.distances[to], state.playedMoves);
+								xstd::minimize(requiredMoves, moves);
+							}
+
+							/* -- Add resulting positions to the next layers -- */
+
+							auto expand = [&](int k, Square squareC) {
+								play(states, checks, crowded, k, { squareA, squareB, squareC }, squaresC, played, availableMoves - moves, [&](Square to, Squares others) {
+									array<int, 3> playedMoves = played;
+									playedMoves[k] += 1;
+
+									MatrixOfSquares& next = positions.squares(playedMoves, visited(k, to, layer.stages));
+									if (k == 0)
+										next[to][squareB] |= others;
+									else if (k == 1)
+										next[squareA][to] |= others;
+									else
+										next[squareA][squareB] |= to;
+								});
+							};
+
+							expand(0, Nowhere);
+							expand(1, Nowhere);
+							for (Square squareC : ValidSquares(squaresC))
+								expand(2, squareC);
+
+							/* -- Give up as soon as the search space grows too large -- */
+
+							if (positions.size() > maximumLayers)
+								return -1;
+						}
+					}
+				}
 			}
+		}
+	}
+
+	/* -- Early exit if our goal can not be reached -- */
+
+	if (requiredMoves >= Infinity)
+		return requiredMoves;
 
-			/* -- Undo move -- */
+	/* -- Backward pass: keep positions that lead to our goal, and label the moves used -- */
+
+	ThreePieceLayers solutions(maximumMoves[0], maximumMoves[1], maximumMoves[2]);
+
+	for (int moves = availableMoves; moves >= 0; moves--)
+	{
+		for (int movesA = 0; movesA <= std::min(moves, maximumMoves[0]); movesA++)
+		{
+			for (int movesB = std::max(0, moves - movesA - maximumMoves[2]); movesB <= std::min(moves - movesA, maximumMoves[1]); movesB++)
+			{
+				const array<int, 3> played = { movesA, movesB, moves - movesA - movesB };
 
-			state.availableMoves += 1;
-			state.playedMoves -= 1;
-			state.square = from;
-			state.visits = visits;
+				for (const Layer& layer : positions.layers(played))
+				{
+					MatrixOfSquares& solved = solutions.squares(played, layer.stages);
 
-			/* -- Update required moves -- */
+					for (Square squareA : AllSquares())
+					{
+						for (Square squareB : AllSquares())
+						{
+							const Squares squaresC = layer.squares[squareA][squareB];
+							if (!squaresC)
+								continue;
 
-			xstd::minimize(requiredMoves, myRequiredMoves);
+							/* -- A position is solved if our goal is reached or if it leads to a solved position -- */
+
+							solved[squareA][squareB] |= squaresC & goal({ squareA, squareB }, layer.stages);
+
+							auto expand = [&](int k, Square squareC) {
+								const array<Square, 3> squares = { squareA, squareB, squareC };
+								play(states, checks, crowded, k, squares, squaresC, played, availableMoves - moves, [&](Square to, Squares others) {
+									array<int, 3> playedMoves = played;
+									playedMoves[k] += 1;
+
+									const MatrixOfSquares *successors = solutions.find(playedMoves, visited(k, to, layer.stages));
+									if (!successors)
+										return;
+
+									Squares alive;
+									if (k == 0)
+										alive = (*successors)[to][squareB] & others;
+									else if (k == 1)
+										alive = (*successors)[squareA][to] & others;
+									else if ((*successors)[squareA][squareB][to])
+										alive = squareC;
+
+									if (alive)
+									{
+										solved[squareA][squareB] |= alive;
+										states[k].moves[squares[k]][to] = true;
+										xstd::minimize(states[k].distances[to], played[k] + 1);
+									}
+								});
+							};
+
+							expand(0, Nowhere);
+							expand(1, Nowhere);
+							for (Square squareC : ValidSquares(squaresC))
+								expand(2, squareC);
+						}
+					}
+				}
+			}
 		}
 	}
 
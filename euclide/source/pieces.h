@@ -11,9 +11,13 @@ class Pieces;
 class Actions;
 class Problem;
 class Consequences;
-class TwoPieceCache;
+class Impacts;
+struct Stage;
+class TwoPieceLayers;
+class ThreePieceLayers;
 class PieceConditions;
 class TwoPieceFastCache;
+class DistancesCache;
 
 /* -------------------------------------------------------------------------- */
 /* -- Piece                                                                -- */
@@ -22,7 +26,10 @@ class TwoPieceFastCache;
 class Piece
 {
 	public:
-		Piece(const Problem& problem, Square square, Man man, Glyph glyph = Empty, tribool promoted = unknown);
+		typedef std::list<Piece, ArenaAllocator<Piece>> Personalities;
+
+	public:
+		Piece(const Problem& problem, Square square, Man man, Arena& arena, Glyph glyph = Empty, tribool promoted = unknown);
 		~Piece();
 
 		void initializeActions();
@@ -44,10 +51,16 @@ class Piece
 
 		void bypassObstacles(const Piece& blocker);
 		static int mutualInteractions(Piece& pieceA, Piece& pieceB, const array<int, NumColors>& freeMoves, bool fast);
+		static int mutualInteractions(Piece& pieceA, Piece& pieceB, Piece& pieceC, const array<int, NumColors>& freeMoves);
+		static bool interacts(const Piece& pieceA, const Piece& pieceB);
 
-		void findConsequences(const std::array<Pieces, NumColors>& pieces);
+		void findConsequences(const std::array<Pieces, NumColors>& pieces, DistancesCache& cache);
+		void compileConsequences();
 
 		bool update();
+		void updateOccupiedSquares();
+
+		array<int, 2> requiredMovesByParity() const;
 
 	public:
 		inline Man man() const
@@ -97,6 +110,8 @@ class Piece
 			{ return m_piece; }
 		inline Piece *piece()
 			{ return m_piece; }
+		inline Personalities& personalities()
+			{ return m_personalities; }
 
 		inline int availableMoves() const
 			{ return m_availableMoves; }
@@ -141,6 +156,9 @@ class Piece
 		inline Squares reachableSquares(Squares squares, int availableMoves, int availableCaptures, Glyph glyph) const
 			{ return Squares([&](Square square) { return (requiredMovesTo(square, glyph) <= availableMoves) && (requiredCapturesTo(square, glyph) <= availableCaptures); }, ValidSquares(squares)); }
 
+		inline int occupier() const
+			{ return m_color * MaxPieces + m_man; }
+
 		inline int nmoves() const
 			{ return m_nmoves; }
 
@@ -163,7 +181,7 @@ class Piece
 		inline const Actions& actions() const
 			{ return *m_actions; }
 		const Action& action(Square from, Square to) const;
-		const Consequences& consequences(Square from, Square to) const;
+		Impacts consequences(Square from, Square to) const;
 
 	public:
 		inline bool operator==(const Piece& piece) const
@@ -180,6 +198,10 @@ class Piece
 		void updateCapturesTo();
 		void updateConsequences();
 
+		static Squares obstructions(const ArrayOfSquares& constraints, Square from, Squares obstacles);
+		static Squares successors(const ArrayOfSquares& moves, Squares squares);
+		static Squares predecessors(const ArrayOfSquares& moves, Squares squares, Squares candidates);
+
 		array<int, NumSquares> computeDistances(Square initial, Square castling, bool pawn) const;
 		array<int, NumSquares> computeDistances(Squares promotions, const array<int, NumSquares>& initial) const;
 		array<int, NumSquares> computeDistancesTo(Squares destinations, bool pawn) const;
@@ -198,26 +220,49 @@ class Piece
 
 			int availableMoves;                  /**< Number of available moves for this piece. */
 			int requiredMoves;                   /**< Number of moves required for this piece. */
-			int playedMoves;                     /**< Number of moves currently played. */
 
 			ArrayOfSquares moves;                /**< All moves that leads to the possible final squares in time. */
 			ArrayOfSquares squares;              /**< Occupied pair of squares. */
-			Squares visits;                      /**< List of visited squares. */
-			Square square;                       /**< Current square. */
 
 			array<int, NumSquares> distances;    /**< Moves required to reach each square, assuming goals are reached. */
 
-			State(Piece& piece, int availableMoves) : piece(piece), teleportation((piece.m_castlingSquare != Nowhere) && !piece.m_distances[piece.m_castlingSquare]), availableMoves(availableMoves), requiredMoves(Infinity), playedMoves(0), visits(), square(piece.m_initialSquare)
+			ArrayOfSquares pawnMoves;            /**< Same as above, for initial pawn when the piece is promoted. */
+
+			State(Piece& piece, int availableMoves) : piece(piece), teleportation((piece.m_castlingSquare != Nowhere) && !piece.m_distances[piece.m_castlingSquare]), availableMoves(availableMoves), requiredMoves(Infinity)
 			{
 				distances.fill(Infinity);
 				distances[piece.m_initialSquare] = 0;
 			}
 		};
 
+		struct Movements
+		{
+			const ArrayOfSquares& moves;                 /**< Set of legal moves. */
+			const MatrixOfSquares& constraints;          /**< Move constraints. */
+			const ArrayOfSquares& checks;                /**< Squares on which the enemy king is in check. */
+			const array<int, NumSquares>& rdistances;    /**< Number of moves required to reach one of the final squares. */
+
+			Movements(const ArrayOfSquares& moves, const MatrixOfSquares& constraints, const ArrayOfSquares& checks, const array<int, NumSquares>& rdistances) : moves(moves), constraints(constraints), checks(checks), rdistances(rdistances) {}
+		};
+
+		Movements movements(const Stage& stage) const;
+		Squares goals(const Stage& stage) const;
+
 		static int fastplay(array<State, 2>& states, int availableMoves);
 		static int fullplay(array<State, 2>& states, int availableMoves);
 		static int fastplay(array<State, 2>& states, int availableMoves, TwoPieceFastCache& cache);
-		static int fullplay(array<State, 2>& states, int availableMoves, int maximumMoves, TwoPieceCache& cache);
+		static int fullplay(array<State, 2>& states, int availableMoves, TwoPieceLayers& positions, TwoPieceLayers& solutions);
+
+		static int fullplay(array<State, 3>& states, int availableMoves);
+		static int fullplay(array<State, 3>& states, int availableMoves, ThreePieceLayers& positions);
+
+		static bool blocked(const Piece& piece, const Movements& movements, Square from, Square to, const Piece& xpiece, const Movements& xmovements, Square other);
+		template <typename Function>
+		static void transit(const array<State, 2>& states, int k, const array<Square, 2>& squares, const array<Stage, 2>& stages, const array<int, 2>& moves, const Function& function);
+		template <typename Function>
+		static void play(const array<State, 2>& states, int k, const array<Square, 2>& squares, const array<Stage, 2>& stages, const array<int, 2>& moves, int availableMoves, const Function& function);
+		template <typename Function>
+		static void play(const array<State, 3>& states, const array<ArrayOfSquares, 3>& checks, Squares crowded, int k, const array<Square, 3>& squares, Squares others, const array<int, 3>& moves, int availableMoves, const Function& function);
 
 	private:
 		Man m_man;                                     /**< Piece's man. */
@@ -238,7 +283,7 @@ class Piece
 		tribool m_promoted;                            /**< Set if the piece has been promoted. */
 
 		Glyphs m_glyphs;                               /**< Piece's possible final glyphs. Includes piece's glyph. */
-		std::list<Piece> m_personalities;              /**< Possible pieces. At most five entries for pawns. */
+		Personalities m_personalities;                 /**< Possible pieces. At most five entries for pawns. */
 		array<Piece *, NumGlyphs> m_pieces;            /**< Pointer to pieces for each personalities. One entry must be non null. */
 		Piece *m_piece;                                /**< Master piece for personalities, or 'this' if we are not a virtual piece. */
 		bool m_virtual;                                /**< Set if this piece is a possible piece (a personality) which may not exist. */
@@ -258,6 +303,7 @@ class Piece
 		array<int, NumSquares> m_rcaptures;            /**< Number of moves required to reach one of the final squares. */
 
 		ArrayOfSquares m_moves;                        /**< Set of legal moves. */
+		const ArrayOfSquares *m_legalMoves;            /**< Shared table legal moves were initially copied from. */
 		const ArrayOfSquares *m_xmoves;                /**< Set of moves that must be captures, or null if there are no restrictions. */
 		const MatrixOfSquares *m_constraints;          /**< Move constraints, i.e. squares that must be empty for each possible move. */
 		const MatrixOfSquares *m_xconstraints;         /**< Capture move constraints, i.e. squares that must be empty for each possible capture. */
@@ -270,6 +316,7 @@ class Piece
 			array<int, NumSquares> rcaptures;
 
 			ArrayOfSquares moves;
+			const ArrayOfSquares *legalMoves;
 			const ArrayOfSquares *xmoves;
 			const MatrixOfSquares *constraints;
 			const MatrixOfSquares *xconstraints;
@@ -278,8 +325,9 @@ class Piece
 
 		int m_nmoves;                                  /**< Total number of legal moves. */
 
-		struct Occupied { Squares squares; array<Piece *, NumSquares> pieces; };
-		array<Occupied, NumSquares> m_occupied;        /**< Occupied squares, for each square the piece may lie. */
+		struct Occupied { Squares squares; array<uint8_t, NumSquares> pieces; };
+		array<Occupied, NumSquares> m_occupied;        /**< Occupied squares, for each square the piece may lie, with occupying pieces indices. */
+		array<const Piece *, 2 * MaxPieces> m_occupiers;    /**< Occupying pieces, indexed by color and man. */
 
 		Squares m_stops;                               /**< Set of squares on which the piece may have stopped. */
 		Squares m_visits;                              /**< Set of squares on which the piece must have stopped. */
@@ -289,6 +337,8 @@ class Piece
 		Actions *m_actions;                            /**< Actions associated with possible piece moves and their consequences. */
 
 		bool m_update;                                 /**< Set when deductions must be updated and update() shall return true. */
+		bool m_occupy;                                 /**< Set when deductions have been updated, but occupied squares not yet. */
+		unsigned m_version;                            /**< Incremented each time deductions are updated. */
 
 	public:
 		mutable struct {
@@ -305,7 +355,11 @@ class Piece
 /* -- Pieces                                                               -- */
 /* -------------------------------------------------------------------------- */
 
-class Pieces : public std::vector<Piece> {};
+class Pieces : public std::vector<Piece, ArenaAllocator<Piece>>
+{
+	public:
+		Pieces(Arena& arena) : std::vector<Piece, ArenaAllocator<Piece>>(ArenaAllocator<Piece>(arena)) {}
+};
 
 /* -------------------------------------------------------------------------- */
 
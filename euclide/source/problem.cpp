@@ -67,19 +67,14 @@ Problem::Problem(const EUCLIDE_Problem& problem)
 		{ pawns, countof(pawns) }, { pawns, countof(pawns) }
 	};
 
-	if (xstd::all(m_pieces, None))
-		for (int glyph = 0; glyph < NumGlyphs; glyph++)
+	for (int glyph = 0; glyph < NumGlyphs; glyph++)
+		if (m_pieces[glyph] == None)
 			m_pieces[glyph] = species[glyph].species[0];
 
 	for (Glyph glyph : AllGlyphs())
 		if (xstd::none(species[glyph].species, species[glyph].species + species[glyph].numSpecies, m_pieces[glyph]))
 			throw InvalidProblem;
 
-	static const Species unimplementedSpecies[] = { Grasshopper, Leo, Pao, Vao };
-	for (Glyph glyph : AllGlyphs())
-		if (xstd::any(unimplementedSpecies, unimplementedSpecies + countof(unimplementedSpecies), m_pieces[glyph]))
-			throw UnimplementedFeature;
-
 	/* -- Initialize chess variants -- */
 
 	m_variant = static_cast<Variant>(problem.variant);
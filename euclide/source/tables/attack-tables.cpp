@@ -0,0 +1,132 @@
+#include "tables.h"
+
+namespace Euclide
+{
+namespace Tables
+{
+
+/* -------------------------------------------------------------------------- */
+
+static const int RookDirections[4][2] = { { 0, 1 }, { 0, -1 }, { 1, 0 }, { -1, 0 } };
+static const int BishopDirections[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+static const int RookTableSize = 0x19000;
+static const int BishopTableSize = 0x1480;
+
+/* -- Magic factors, found once by random search, unused when PEXT is available -- */
+
+static const uint64_t RookMagics[NumSquares] =
+{
+	UINT64_C(0x1080004008801020), UINT64_C(0x0840092002C03000), UINT64_C(0x1900200010400900), UINT64_C(0x0880100008000480), UINT64_C(0x4200100420080200), UINT64_C(0x8100020100080400), UINT64_C(0x0200040110886200), UINT64_C(0x0200008040220411),
+	UINT64_C(0x0404800084400220), UINT64_C(0x0000401000402000), UINT64_C(0x0086001081220440), UINT64_C(0x0408800800100280), UINT64_C(0x000A001201040820), UINT64_C(0x8848800200840080), UINT64_C(0x4001000100040200), UINT64_C(0x0442000102105084),
+	UINT64_C(0x9080010020804100), UINT64_C(0x0040404000201009), UINT64_C(0x0000808010002009), UINT64_C(0x2200090021D00100), UINT64_C(0x0008008008040080), UINT64_C(0x0004004002010040), UINT64_C(0x0011040008015042), UINT64_C(0x00000A0001768104),
+	UINT64_C(0x0000800080204009), UINT64_C(0x2010004140002001), UINT64_C(0x9800200280100080), UINT64_C(0x1000100080080080), UINT64_C(0x0442000A00049020), UINT64_C(0x2100040080020080), UINT64_C(0x0800120400900148), UINT64_C(0x0010040A00128541),
+	UINT64_C(0x2800804000800030), UINT64_C(0x1010002000400041), UINT64_C(0x4000200011004100), UINT64_C(0x0610008410800800), UINT64_C(0x0400802402800800), UINT64_C(0xC100020080800400), UINT64_C(0x0002000802000401), UINT64_C(0x0182085882000401),
+	UINT64_C(0x0220204000808000), UINT64_C(0x2860100040024022), UINT64_C(0x0001002004110040), UINT64_C(0x99101042000A0020), UINT64_C(0x0004080004008080), UINT64_C(0x0010040002008080), UINT64_C(0x2012004881020004), UINT64_C(0x8300842444820011),
+	UINT64_C(0x0088403882010200), UINT64_C(0x0820400080210100), UINT64_C(0x0110910040A00300), UINT64_C(0x0801100280080480), UINT64_C(0x0242009008200600), UINT64_C(0x1002000489500200), UINT64_C(0x0040800200010080), UINT64_C(0x0091800041000080),
+	UINT64_C(0x0000209300488001), UINT64_C(0x04C1002414824001), UINT64_C(0x020020000B001041), UINT64_C(0x7000100004200901), UINT64_C(0x8002002004100802), UINT64_C(0x30010002084C0007), UINT64_C(0x0888221800813004), UINT64_C(0x4000002840840112)
+};
+
+static const uint64_t BishopMagics[NumSquares] =
+{
+	UINT64_C(0x10102002004A1420), UINT64_C(0x8020040400584008), UINT64_C(0x10510800811201C8), UINT64_C(0x5204042080000088), UINT64_C(0x2204106880000002), UINT64_C(0x1401042004000000), UINT64_C(0x0400880410042004), UINT64_C(0x0028208200A02020),
+	UINT64_C(0x1500241990010E00), UINT64_C(0x8001200182020A40), UINT64_C(0x40004101030B0000), UINT64_C(0x8002041042000100), UINT64_C(0x4010011041020038), UINT64_C(0x0000010421044000), UINT64_C(0x1500210808020A00), UINT64_C(0x8000088400880520),
+	UINT64_C(0x0405004010040100), UINT64_C(0x1005823210040108), UINT64_C(0x2708008102040011), UINT64_C(0x4048200404009100), UINT64_C(0x0018104101400024), UINT64_C(0x0003000601190101), UINT64_C(0x8004803108491000), UINT64_C(0x8014241200820800),
+	UINT64_C(0x0006E080100C3040), UINT64_C(0x0501044A11041800), UINT64_C(0x9020300008004045), UINT64_C(0x0894080000220040), UINT64_C(0x1001010083104000), UINT64_C(0x5004030040900080), UINT64_C(0x000400422C012400), UINT64_C(0x0002128698404812),
+	UINT64_C(0x1010108404900440), UINT64_C(0x0928021182084100), UINT64_C(0x2006080409020024), UINT64_C(0x1010202020180080), UINT64_C(0xA010008200202200), UINT64_C(0x2098015100019004), UINT64_C(0x0002041440810811), UINT64_C(0x802A02020000B098),
+	UINT64_C(0x0009015090004060), UINT64_C(0x4000821082081001), UINT64_C(0x0100210040420800), UINT64_C(0x0800004010488A00), UINT64_C(0x2000081104004040), UINT64_C(0x4C8E029015000082), UINT64_C(0x0420340322224842), UINT64_C(0x1298260043400210),
+	UINT64_C(0x0000822802400008), UINT64_C(0x00008A0101600000), UINT64_C(0x3040003412080021), UINT64_C(0x3040290220884800), UINT64_C(0x4A1500401041004A), UINT64_C(0x8010200282020781), UINT64_C(0x0020203142209091), UINT64_C(0x0070300600902110),
+	UINT64_C(0x0040808800B62048), UINT64_C(0x0000810400C44420), UINT64_C(0x00080400440C0441), UINT64_C(0x8340080020840411), UINT64_C(0x0000000104208200), UINT64_C(0x0000800810D00080), UINT64_C(0x0400530411080200), UINT64_C(0x4040702400932244)
+};
+
+/* -------------------------------------------------------------------------- */
+
+static Squares slide(Square square, const int (&directions)[4][2], Squares occupied, bool edges)
+{
+	Squares squares;
+
+	for (const int (&direction)[2] : directions)
+	{
+		for (int x = col(square) + direction[0], y = row(square) + direction[1]; (x >= 0) && (x < 8) && (y >= 0) && (y < 8); x += direction[0], y += direction[1])
+		{
+			/* -- Squares on the board edge never block anything beyond them -- */
+
+			if (!edges && ((x + direction[0] < 0) || (x + direction[0] >= 8) || (y + direction[1] < 0) || (y + direction[1] >= 8)))
+				break;
+
+			squares.set(Euclide::square(x, y));
+			if (occupied[Euclide::square(x, y)])
+				break;
+		}
+	}
+
+	return squares;
+}
+
+/* -------------------------------------------------------------------------- */
+
+static void initialize(Magics& magics, Squares *attacks, const int (&directions)[4][2], const uint64_t (&factors)[NumSquares])
+{
+	for (Square square : AllSquares())
+	{
+		Magic& magic = magics[square];
+
+		magic.attacks = attacks;
+		magic.mask = slide(square, directions, Squares(), false);
+		magic.magic = factors[square];
+		magic.shift = 64 - magic.mask.count();
+
+		/* -- Store attacks for all relevant occupancies, enumerated as subsets of the mask -- */
+
+		uint64_t occupied = 0;
+		do
+		{
+			assert(!attacks[magic.index(occupied)] || (attacks[magic.index(occupied)] == slide(square, directions, occupied, true)));
+			attacks[magic.index(occupied)] = slide(square, directions, occupied, true);
+			occupied = (occupied - magic.mask) & magic.mask;
+		} while (occupied);
+
+		attacks += size_t(1) << magic.mask.count();
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+struct AttackTables
+{
+	AttackTables()
+	{
+		initialize(rooks, rookAttacks.data(), RookDirections, RookMagics);
+		initialize(bishops, bishopAttacks.data(), BishopDirections, BishopMagics);
+	}
+
+	Magics rooks;                                        /**< Rook magics, for each square. */
+	Magics bishops;                                      /**< Bishop magics, for each square. */
+
+	array<Squares, RookTableSize> rookAttacks;           /**< Rook attacks, shared by all squares. */
+	array<Squares, BishopTableSize> bishopAttacks;       /**< Bishop attacks, shared by all squares. */
+};
+
+static const AttackTables& tables()
+{
+	static const AttackTables tables;
+	return tables;
+}
+
+/* -------------------------------------------------------------------------- */
+
+const Magics& getRookMagics()
+{
+	return tables().rooks;
+}
+
+/* -------------------------------------------------------------------------- */
+
+const Magics& getBishopMagics()
+{
+	return tables().bishops;
+}
+
+/* -------------------------------------------------------------------------- */
+
+}}
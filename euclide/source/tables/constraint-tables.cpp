@@ -81,7 +81,7 @@ static constexpr uint64_t neighbors(Square square)
 
 static constexpr uint64_t grasshopper(Square from, Square to, bool capture)
 {
-	return runner(from, to, capture) & neighbors(to);
+	return runner(from, to, capture) & ~neighbors(to);
 }
 
 static constexpr uint64_t mao(Square from, Square to, bool capture)
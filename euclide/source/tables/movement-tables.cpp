@@ -222,15 +222,58 @@ const ArrayOfSquares *getCaptureMoves(Species species, Color color, Variant vari
 
 /* -------------------------------------------------------------------------- */
 
-void initializeLineOfSights(const array<Species, NumGlyphs>& species, Variant variant, array<MatrixOfSquares, NumColors> *lines)
+const ArrayOfSquares *getLegalMoves(Species species, Color color, Variant variant, tribool capture, bool promotion)
 {
+	/* -- Tables are built on first use, then shared by all games and pieces -- */
+
+	static const ArrayOfSquares none;
+	if ((species == None) || (color == Neutral))
+		return &none;
+
+	static std::mutex mutex;
+	static array<std::unique_ptr<ArrayOfSquares>, NumSpecies * NumColors * NumVariants * 3 * 2> registry;
+
+	const int captures = unknown(capture) ? 2 : is(capture) ? 1 : 0;
+	const int index = (((species * NumColors + color) * NumVariants + variant) * 3 + captures) * 2 + (promotion ? 1 : 0);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (!registry[index])
+	{
+		registry[index].reset(new ArrayOfSquares());
+		initializeLegalMoves(registry[index].get(), species, color, variant, capture, promotion);
+	}
+
+	return registry[index].get();
+}
+
+/* -------------------------------------------------------------------------- */
+
+const array<MatrixOfSquares, NumColors> *getLineOfSights(const array<Species, NumGlyphs>& species, Variant variant)
+{
+	/* -- Tables are built on first use for each set of pieces, then shared by all games -- */
+
+	static std::mutex mutex;
+	static std::map<std::pair<array<Species, NumGlyphs>, Variant>, std::unique_ptr<array<MatrixOfSquares, NumColors>>> registry;
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::unique_ptr<array<MatrixOfSquares, NumColors>>& lines = registry[std::make_pair(species, variant)];
+	if (lines)
+		return lines.get();
+
+	lines.reset(new array<MatrixOfSquares, NumColors>());
+
 	for (Glyph glyph : AllGlyphs())
 	{
 		Color color = Euclide::color(glyph);
 
-		ArrayOfSquares captures;
-		initializeLegalMoves(&captures, species[glyph], color, variant, true, true);
-		const MatrixOfSquares *constraints = getMoveConstraints(species[glyph], variant, true);
+		/* -- Cannons may capture over any piece standing between them and their target, provided it is the only one -- */
+
+		const bool cannon = (species[glyph] == Leo) || (species[glyph] == Pao) || (species[glyph] == Vao);
+
+		const ArrayOfSquares& captures = *getLegalMoves(species[glyph], color, variant, true, true);
+		const MatrixOfSquares *constraints = getMoveConstraints(cannon ? Queen : species[glyph], variant, true);
 
 		for (Square from : AllSquares())
 		{
@@ -243,6 +286,8 @@ void initializeLineOfSights(const array<Species, NumGlyphs>& species, Variant va
 			}
 		}
 	}
+
+	return lines.get();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -11,13 +11,82 @@ namespace Tables
 /* -------------------------------------------------------------------------- */
 
 void initializeLegalMoves(ArrayOfSquares *moves, Species species, Color color, Variant variant, tribool capture, bool promotion);
+const ArrayOfSquares *getLegalMoves(Species species, Color color, Variant variant, tribool capture, bool promotion);
 
 const ArrayOfSquares *getCaptureMoves(Species species, Color color, Variant variant, bool null = true);
 const MatrixOfSquares *getMoveConstraints(Species species, Variant variant, bool capture, bool null = true);
 
 const ArrayOfSquares *getUnstoppableChecks(Species species, Color color, Variant variant);
 
-void initializeLineOfSights(const array<Species, NumGlyphs>& species, Variant variant, array<MatrixOfSquares, NumColors> *lines);
+const array<MatrixOfSquares, NumColors> *getLineOfSights(const array<Species, NumGlyphs>& species, Variant variant);
+
+/* -------------------------------------------------------------------------- */
+
+struct Magic
+{
+	const Squares *attacks;    /**< Attacked squares, for each relevant occupancy. */
+	Squares mask;              /**< Relevant occupied squares, board edges excluded. */
+	uint64_t magic;            /**< Factor hashing relevant occupancies to distinct indices. */
+	int shift;                 /**< Index shift, i.e. 64 minus the number of relevant squares. */
+
+	inline size_t index(Squares occupied) const
+#ifdef __BMI2__
+		{ return size_t(intel::pext(occupied, mask)); }
+#else
+		{ return size_t((uint64_t(occupied & mask) * magic) >> shift); }
+#endif
+
+	inline Squares operator()(Squares occupied) const
+		{ return attacks[index(occupied)]; }
+	inline Squares lines() const
+		{ return attacks[0]; }
+};
+
+typedef array<Magic, NumSquares> Magics;
+
+const Magics& getRookMagics();
+const Magics& getBishopMagics();
+
+/* -------------------------------------------------------------------------- */
+
+/* -- Hopper moves depend on the whole position and are computed during the search, hence inline rather than built with the tables -- */
+
+inline Squares hops(const Magics& magics, Square square, Squares occupied, bool grasshopper)
+{
+	/* -- Hurdles are the first pieces met along each line, removing them reveals the squares beyond, up to the next piece -- */
+
+	const Squares visible = magics[square](occupied);
+	const Squares hurdles = visible & occupied;
+	const Squares beyond = magics[square](occupied - hurdles) - visible;
+
+	/* -- Cannons move freely and capture the piece met beyond the hurdle -- */
+
+	if (!grasshopper)
+		return (visible - occupied) | (beyond & occupied);
+
+	/* -- Grasshoppers land right behind the hurdle, i.e. on the neighbor seen from the hurdle when all squares are occupied -- */
+
+	Squares landings;
+	for (Square hurdle : ValidSquares(hurdles))
+		landings |= beyond & magics[hurdle](Squares().set());
+
+	return landings;
+}
+
+inline Squares getHopperMoves(Species species, Square square, Squares occupied, const Magics& rooks, const Magics& bishops)
+{
+	assert((species == Grasshopper) || (species == Leo) || (species == Pao) || (species == Vao));
+
+	Squares moves;
+
+	if (species != Vao)
+		moves |= hops(rooks, square, occupied, species == Grasshopper);
+
+	if (species != Pao)
+		moves |= hops(bishops, square, occupied, species == Grasshopper);
+
+	return moves;
+}
 
 /* -------------------------------------------------------------------------- */
 
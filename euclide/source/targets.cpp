@@ -40,48 +40,113 @@ bool Target::updatePossibleMen(Men men)
 	return true;
 }
 
+/* -------------------------------------------------------------------------- */
+/* -- Targets                                                              -- */
 /* -------------------------------------------------------------------------- */
 
-bool Target::applyPigeonHolePrinciple(Targets& targets, Captures& captures) const
+bool Targets::update(Captures& captures)
 {
-	bool updated = false;
+	typedef BitSet<int, MaxPieces> Destinations;
 
-	Squares squares;
-	for (const Target& target : targets)
-		if (target.men() == m_men)
-			squares.set(target.square());
+	const int t = size();
+	const int n = t + captures.size();
+
+	/* -- Each target and capture requires a distinct man -- */
+
+	if (n > MaxPieces)
+		throw NoSolution;
 
-	if (squares.count() >= m_men.count())
+	array<Men, MaxPieces> men;
+	for (int d = 0; d < n; d++)
+		men[d] = (d < t) ? (*this)[d].men() : captures[d - t].men();
+
+	/* -- Find a matching of all targets and captures, using shortest augmenting paths -- */
+
+	array<Man, MaxPieces> matches;
+	array<int, MaxPieces> owners;
+	matches.fill(-1);
+	owners.fill(-1);
+
+	for (int d = 0; d < n; d++)
 	{
-		for (Target& target : targets)
-			if (target.men() != m_men)
-				if (target.updatePossibleMen(~m_men))
-					updated = true;
-
-		for (Capture& capture : captures)
-			if (capture.updatePossibleMen(~m_men, capture.xmen()))
-				updated = true;
+		array<int, MaxPieces> previous;
+		Queue<int, MaxPieces> queue;
+		Men visited;
+		Man free = -1;
+
+		for (queue.push(d); !queue.empty() && (free < 0); queue.pop())
+		{
+			for (Man man : ValidMen(men[queue.front()] & ~visited))
+			{
+				visited.set(man);
+				previous[man] = queue.front();
+
+				if (owners[man] < 0)
+				{
+					free = man;
+					break;
+				}
+
+				queue.push(owners[man]);
+			}
+		}
+
+		if (free < 0)
+			throw NoSolution;
+
+		for (Man man = free; man >= 0; )
+		{
+			const int owner = previous[man];
+			const Man next = matches[owner];
+
+			matches[owner] = man;
+			owners[man] = owner;
+			man = next;
+		}
 	}
 
-	return updated;
-}
+	/* -- Find destinations reachable through alternating paths, i.e. that can give up their man to another one -- */
 
-/* -------------------------------------------------------------------------- */
-/* -- Targets                                                              -- */
-/* -------------------------------------------------------------------------- */
+	Men unmatched;
+	for (int d = 0; d < n; d++)
+		unmatched |= men[d];
+	for (int d = 0; d < n; d++)
+		unmatched.reset(matches[d]);
 
-bool Targets::update(Captures& captures)
-{
-	bool reduced = false;
-	for (bool updated = true; updated; reduced |= updated)
+	array<Destinations, MaxPieces> reachable;
+	for (int d = 0; d < n; d++)
 	{
-		updated = false;
-		for (const Target& target : *this)
-			if (target.applyPigeonHolePrinciple(*this, captures))
-				updated = true;
+		reachable[d].set(d);
+		for (Man man : ValidMen(men[d] & ~unmatched))
+			reachable[d].set(owners[man]);
 	}
 
-	return reduced;
+	for (int k = 0; k < n; k++)
+		for (int d = 0; d < n; d++)
+			if (reachable[d][k])
+				reachable[d] |= reachable[k];
+
+	Destinations releasable;
+	for (int d = 0; d < n; d++)
+		for (int k : Destinations::BitSetRange(reachable[d]))
+			if (men[k] & unmatched)
+				releasable.set(d);
+
+	/* -- Keep only edges that belong to some matching: matched edges, edges to unmatched men, and edges closing an alternating cycle or path -- */
+
+	bool updated = false;
+	for (int d = 0; d < n; d++)
+	{
+		Men possible = Men(matches[d]) | (men[d] & unmatched);
+		for (Man man : ValidMen(men[d] & ~unmatched))
+			if (reachable[owners[man]][d] || releasable[owners[man]])
+				possible.set(man);
+
+		if ((d < t) ? (*this)[d].updatePossibleMen(possible) : captures[d - t].updatePossibleMen(possible, captures[d - t].xmen()))
+			updated = true;
+	}
+
+	return updated;
 }
 
 /* -------------------------------------------------------------------------- */
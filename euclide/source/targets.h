@@ -26,8 +26,6 @@ class Target
 
 		bool updatePossibleMen(Men men);
 
-		bool applyPigeonHolePrinciple(Targets& targets, Captures& captures) const;
-
 	public:
 		inline Glyph glyph() const
 			{ return m_glyph; }
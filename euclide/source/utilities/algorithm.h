@@ -178,13 +178,13 @@ template <class T>
 void minimize(T *variables, const T *values, int size)
 	{ for (int k = 0; k < size; k++) variables[k] = std::min(variables[k], values[k]); }
 
-template <class T, int N>
+template <class T, size_t N>
 void maximize(array<T, N>& variables, const array<T, N>& values)
 {
 	maximize(variables.data(), values.data(), N);
 }
 
-template <class T, int N>
+template <class T, size_t N>
 void minimize(array<T, N>& variables, const array<T, N>& values)
 {
 	minimize(variables.data(), values.data(), N);
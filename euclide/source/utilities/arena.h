@@ -0,0 +1,172 @@
+#ifndef __EUCLIDE_ARENA_H
+#define __EUCLIDE_ARENA_H
+
+#include "../includes.h"
+
+namespace Euclide
+{
+
+/* -------------------------------------------------------------------------- */
+/* -- Arena                                                                -- */
+/* -------------------------------------------------------------------------- */
+
+class Arena
+{
+	public:
+		Arena(size_t size = 1 << 18);
+		~Arena();
+
+		void *allocate(size_t size, size_t alignment);
+		void reset();
+
+		template <typename T, typename... Args>
+		T *create(Args&&... args)
+			{ return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...); }
+
+		template <typename T>
+		static void destroy(T *object)
+			{ if (object) object->~T(); }
+
+	private:
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		void release();
+
+	private:
+		struct Block { Block *next; size_t size; };
+
+		Block *m_blocks;      /**< Allocated blocks, most recent first. */
+		char *m_cursor;       /**< Next free byte in current block. */
+		char *m_limit;        /**< End of current block. */
+
+		size_t m_size;        /**< Size of the next block to allocate. */
+		size_t m_capacity;    /**< Total size of allocated blocks. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+inline Arena::Arena(size_t size)
+	: m_blocks(nullptr), m_cursor(nullptr), m_limit(nullptr), m_size(size), m_capacity(0)
+{
+}
+
+/* -------------------------------------------------------------------------- */
+
+inline Arena::~Arena()
+{
+	release();
+}
+
+/* -------------------------------------------------------------------------- */
+
+inline void *Arena::allocate(size_t size, size_t alignment)
+{
+	char *pointer = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(m_cursor) + alignment - 1) & ~uintptr_t(alignment - 1));
+
+	/* -- Chain a new block when the current one is exhausted -- */
+
+	if (!m_cursor || (pointer + size > m_limit))
+	{
+		const size_t required = sizeof(Block) + size + alignment;
+		const size_t blocksize = std::max(m_size, required);
+
+		Block *block = static_cast<Block *>(::operator new(blocksize));
+		block->next = m_blocks;
+		block->size = blocksize;
+
+		m_blocks = block;
+		m_cursor = reinterpret_cast<char *>(block + 1);
+		m_limit = reinterpret_cast<char *>(block) + blocksize;
+
+		m_size = 2 * blocksize;
+		m_capacity += blocksize;
+
+		pointer = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(m_cursor) + alignment - 1) & ~uintptr_t(alignment - 1));
+	}
+
+	m_cursor = pointer + size;
+	return pointer;
+}
+
+/* -------------------------------------------------------------------------- */
+
+inline void Arena::reset()
+{
+	if (!m_blocks)
+		return;
+
+	/* -- Coalesce blocks, so that a similar workload fits in a single block next time -- */
+
+	if (m_blocks->next)
+	{
+		const size_t capacity = m_capacity;
+		release();
+
+		m_size = capacity;
+		allocate(0, 1);
+	}
+
+	m_cursor = reinterpret_cast<char *>(m_blocks + 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+inline void Arena::release()
+{
+	while (m_blocks)
+	{
+		Block *block = m_blocks;
+		m_blocks = block->next;
+		::operator delete(block);
+	}
+
+	m_cursor = m_limit = nullptr;
+	m_capacity = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+/* -- ArenaAllocator                                                       -- */
+/* -------------------------------------------------------------------------- */
+
+template <typename T>
+class ArenaAllocator
+{
+	public:
+		typedef T value_type;
+
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+	public:
+		ArenaAllocator(Arena& arena)
+			: m_arena(&arena) {}
+		template <typename U>
+		ArenaAllocator(const ArenaAllocator<U>& allocator)
+			: m_arena(&allocator.arena()) {}
+
+		inline T *allocate(size_t n)
+			{ return static_cast<T *>(m_arena->allocate(n * sizeof(T), alignof(T))); }
+		inline void deallocate(T *, size_t)
+			{ }
+
+		inline Arena& arena() const
+			{ return *m_arena; }
+
+	private:
+		Arena *m_arena;    /**< Arena memory is taken from, released all at once. */
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>& allocatorA, const ArenaAllocator<U>& allocatorB)
+	{ return &allocatorA.arena() == &allocatorB.arena(); }
+
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>& allocatorA, const ArenaAllocator<U>& allocatorB)
+	{ return &allocatorA.arena() != &allocatorB.arena(); }
+
+/* -------------------------------------------------------------------------- */
+
+}
+
+#endif
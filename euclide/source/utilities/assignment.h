@@ -0,0 +1,111 @@
+#ifndef __EUCLIDE_ASSIGNMENT_H
+#define __EUCLIDE_ASSIGNMENT_H
+
+#include "../includes.h"
+
+namespace Euclide
+{
+
+/* -------------------------------------------------------------------------- */
+
+template <size_t MaxSize>
+class Assignment
+{
+	public:
+		template <typename Function>
+		Assignment(int rows, int columns, const Function& costs);
+
+		inline int cost() const
+			{ return -m_v[0]; }
+		inline int column(int row) const
+			{ return m_columns[row]; }
+		inline int reduced(int row, int column) const
+			{ return m_costs[row][column] - m_u[row + 1] - m_v[column + 1]; }
+
+	private:
+		matrix<int, MaxSize, MaxSize> m_costs;    /**< Cost of assigning each row to each column. */
+		array<int, MaxSize + 1> m_u;              /**< Row potentials. */
+		array<int, MaxSize + 1> m_v;              /**< Column potentials, never positive. */
+		array<int, MaxSize> m_columns;            /**< Column assigned to each row. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+template <size_t MaxSize>
+template <typename Function>
+Assignment<MaxSize>::Assignment(int rows, int columns, const Function& costs)
+{
+	assert((rows <= columns) && (columns <= int(MaxSize)));
+
+	constexpr int Unreachable = std::numeric_limits<int>::max() / 2;
+
+	for (int row = 0; row < rows; row++)
+		for (int column = 0; column < columns; column++)
+			m_costs[row][column] = costs(row, column);
+
+	/* -- Hungarian algorithm, adding rows one by one and following shortest augmenting paths -- */
+
+	array<int, MaxSize + 1> rowof, way, minv;
+	array<bool, MaxSize + 1> used;
+
+	m_u.fill(0);
+	m_v.fill(0);
+	rowof.fill(0);
+
+	for (int row = 1; row <= rows; row++)
+	{
+		rowof[0] = row;
+		minv.fill(Unreachable);
+		used.fill(false);
+
+		int j0 = 0;
+		do
+		{
+			used[j0] = true;
+
+			const int i0 = rowof[j0];
+			int delta = Unreachable, j1 = 0;
+
+			for (int j = 1; j <= columns; j++)
+			{
+				if (used[j])
+					continue;
+
+				const int cost = m_costs[i0 - 1][j - 1] - m_u[i0] - m_v[j];
+				if (cost < minv[j])
+					minv[j] = cost, way[j] = j0;
+				if (minv[j] < delta)
+					delta = minv[j], j1 = j;
+			}
+
+			for (int j = 0; j <= columns; j++)
+			{
+				if (used[j])
+					m_u[rowof[j]] += delta, m_v[j] -= delta;
+				else
+					minv[j] -= delta;
+			}
+
+			j0 = j1;
+		} while (rowof[j0]);
+
+		do
+		{
+			const int j1 = way[j0];
+			rowof[j0] = rowof[j1];
+			j0 = j1;
+		} while (j0);
+	}
+
+	/* -- Record assignment -- */
+
+	for (int j = 1; j <= columns; j++)
+		if (rowof[j])
+			m_columns[rowof[j] - 1] = j - 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+}
+
+#endif
@@ -89,12 +89,20 @@ class BitSet
 
 	public:
 		inline Type first() const
-			{ int bit; return static_cast<Type>(intel::bsf(m_bits, &bit) ? bit : Bits); }
+			{ return static_cast<Type>(m_bits ? intel::tzcnt(m_bits) : Bits); }
 		inline Type next(int position) const
-			{ int bit; return static_cast<Type>(intel::bsf(m_bits >> position >> 1, &bit) ? bit + position + 1 : Bits); }
+			{ const bits_t bits = m_bits >> position >> 1; return static_cast<Type>(bits ? intel::tzcnt(bits) + position + 1 : Bits); }
 
 		inline Type pop()
-			{ const Type position = first(); assert(m_bits); reset(position); return position; }
+			{ assert(m_bits); const Type position = static_cast<Type>(intel::tzcnt(m_bits)); m_bits = intel::blsr(m_bits); return position; }
+
+	public:
+		template <typename Function> inline
+		void each(const Function& function) const
+			{ for (bits_t bits = m_bits; bits; bits = intel::blsr(bits)) function(static_cast<Type>(intel::tzcnt(bits))); }
+		template <typename Predicate> inline
+		bool any(const Predicate& predicate) const
+			{ for (bits_t bits = m_bits; bits; bits = intel::blsr(bits)) if (predicate(static_cast<Type>(intel::tzcnt(bits)))) return true; return false; }
 
 	public:
 		inline BitSet& operator&=(const BitSet& bitset)
@@ -182,24 +190,23 @@ class BitSet
 				class BitSetIterator : public std::iterator<std::forward_iterator_tag, Type>
 				{
 					public:
-						BitSetIterator() : m_bits(0), m_position(Bits) {}
-						BitSetIterator(const BitSet& bitset) : m_bits(bitset) { operator++(); }
+						BitSetIterator() : m_bits(None) {}
+						BitSetIterator(const BitSet& bitset) : m_bits(bitset) {}
 
 					public:
 						inline bool operator==(const BitSetIterator& iterator) const
-							{ return m_position == iterator.m_position; }
+							{ return m_bits == iterator.m_bits; }
 						inline bool operator!=(const BitSetIterator& iterator) const
-							{ return m_position != iterator.m_position; }
+							{ return m_bits != iterator.m_bits; }
 
 						inline BitSetIterator& operator++()
-							{ intel::bsf(m_bits, &m_position) ? (m_bits = intel::btr(m_bits, m_position)) : (m_position = Bits); return *this; }
+							{ m_bits = intel::blsr(m_bits); return *this; }
 
 						inline Type operator*() const
-							{ assert(m_position < Bits); return static_cast<Type>(m_position); }
+							{ assert(m_bits); return static_cast<Type>(intel::tzcnt(m_bits)); }
 
 					private:
 						bits_t m_bits;
-						int m_position;
 				};
 
 				typedef BitSetIterator iterator;
@@ -230,25 +237,24 @@ class BitSet
 				class BitSetIterator : public std::iterator<std::forward_iterator_tag, Type>
 				{
 					public:
-						BitSetIterator(const Collection& collection) : m_collection(&collection), m_bits(0), m_position(Bits) {}
-						BitSetIterator(const Collection& collection, const BitSet& bitset) : m_collection(&collection), m_bits(bitset) { operator++(); }
+						BitSetIterator(const Collection& collection) : m_collection(&collection), m_bits(None) {}
+						BitSetIterator(const Collection& collection, const BitSet& bitset) : m_collection(&collection), m_bits(bitset) {}
 
 					public:
 						inline bool operator==(const BitSetIterator& iterator) const
-							{ return m_position == iterator.m_position; }
+							{ return m_bits == iterator.m_bits; }
 						inline bool operator!=(const BitSetIterator& iterator) const
-							{ return m_position != iterator.m_position; }
+							{ return m_bits != iterator.m_bits; }
 
 						inline BitSetIterator& operator++()
-							{ intel::bsf(m_bits, &m_position) ? (m_bits = intel::btr(m_bits, m_position)) : (m_position = Bits); return *this; }
+							{ m_bits = intel::blsr(m_bits); return *this; }
 
 						inline typename Collection::const_reference operator*() const
-							{ return (*m_collection)[m_position]; }
+							{ assert(m_bits); return (*m_collection)[intel::tzcnt(m_bits)]; }
 
 					private:
 						const Collection *m_collection;
 						bits_t m_bits;
-						int m_position;
 				};
 
 				typedef BitSetIterator iterator;
@@ -164,6 +164,97 @@ static inline int popcnt(uint64_t bits)
 
 /* -------------------------------------------------------------------------- */
 
+static inline int tzcnt(uint32_t bits)
+{
+	assert(bits);
+
+#if defined(__BMI__)
+	return int(_tzcnt_u32(bits));
+#elif defined(EUCLIDE_WIN_IMPLEMENTATION)
+	unsigned long bit;
+	return _BitScanForward(&bit, bits), int(bit);
+#elif defined(EUCLIDE_LINUX_IMPLEMENTATION)
+	return __builtin_ctz(bits);
+#else
+	int bit = 0;
+	bsf(bits, &bit);
+	return bit;
+#endif
+}
+
+static inline int tzcnt(uint64_t bits)
+{
+	assert(bits);
+
+#if defined(__BMI__)
+	return int(_tzcnt_u64(bits));
+#elif defined(EUCLIDE_WIN_IMPLEMENTATION)
+	unsigned long bit;
+	return _BitScanForward64(&bit, bits), int(bit);
+#elif defined(EUCLIDE_LINUX_IMPLEMENTATION)
+	return __builtin_ctzll(bits);
+#else
+	int bit = 0;
+	bsf(bits, &bit);
+	return bit;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline constexpr uint32_t blsr(uint32_t bits)
+{
+	return bits & (bits - 1);
+}
+
+static inline constexpr uint64_t blsr(uint64_t bits)
+{
+	return bits & (bits - 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint64_t pext(uint64_t bits, uint64_t mask)
+{
+#ifdef __BMI2__
+	return _pext_u64(bits, mask);
+#else
+	uint64_t extracted = 0;
+	for (uint64_t bit = 1; mask; mask &= mask - 1, bit += bit)
+		if (bits & mask & (~mask + 1))
+			extracted |= bit;
+
+	return extracted;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+static inline uint64_t supersets(const uint64_t words[64], uint64_t bits)
+{
+	uint64_t supersets = 0;
+
+	/* -- Both builds target SSE4.2 processors, gcc and clang tell so with a macro, msvc does not -- */
+
+#if defined(__SSE4_1__) || defined(EUCLIDE_WIN_IMPLEMENTATION)
+	const __m128i mask = _mm_set1_epi64x(bits);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (int k = 0; k < 64; k += 2)
+	{
+		const __m128i missing = _mm_andnot_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(words + k)), mask);
+		supersets |= uint64_t(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(missing, zero)))) << k;
+	}
+#else
+	for (int k = 0; k < 64; k++)
+		supersets |= uint64_t((bits & ~words[k]) == 0) << k;
+#endif
+
+	return supersets;
+}
+
+/* -------------------------------------------------------------------------- */
+
 }}
 
 #endif
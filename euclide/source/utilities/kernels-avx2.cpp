@@ -0,0 +1,117 @@
+/* -- Built with AVX2 enabled: include nothing but intrinsics, lest inline functions of shared headers leak AVX2 code into the baseline -- */
+
+#include <cstdint>
+#include <immintrin.h>
+
+namespace Euclide
+{
+namespace Kernels
+{
+namespace AVX2
+{
+
+/* -------------------------------------------------------------------------- */
+
+uint64_t supersets(const uint64_t words[64], uint64_t bits)
+{
+	uint64_t supersets = 0;
+
+	const __m256i mask = _mm256_set1_epi64x(bits);
+	const __m256i zero = _mm256_setzero_si256();
+
+	for (int k = 0; k < 64; k += 4)
+	{
+		const __m256i missing = _mm256_andnot_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + k)), mask);
+		supersets |= uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(missing, zero)))) << k;
+	}
+
+	return supersets;
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint64_t merge(const uint64_t words[64], uint64_t selection)
+{
+	__m256i merged = _mm256_setzero_si256();
+
+	/* -- Expand selection bits into whole lanes, four words at a time -- */
+
+	const __m256i selected = _mm256_set1_epi64x(selection);
+	__m256i lanes = _mm256_setr_epi64x(1, 2, 4, 8);
+
+	for (int k = 0; k < 64; k += 4, lanes = _mm256_slli_epi64(lanes, 4))
+	{
+		const __m256i mask = _mm256_cmpeq_epi64(_mm256_and_si256(selected, lanes), lanes);
+		merged = _mm256_or_si256(merged, _mm256_and_si256(mask, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + k))));
+	}
+
+	const __m128i halves = _mm_or_si128(_mm256_castsi256_si128(merged), _mm256_extracti128_si256(merged, 1));
+	return uint64_t(_mm_cvtsi128_si64(halves)) | uint64_t(_mm_extract_epi64(halves, 1));
+}
+
+/* -------------------------------------------------------------------------- */
+
+int count(const uint64_t words[64])
+{
+	/* -- Count bits of each nibble with a lookup table, then sum bytes of each word -- */
+
+	const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i nibbles = _mm256_set1_epi8(0x0F);
+	const __m256i zero = _mm256_setzero_si256();
+
+	__m256i counts = zero;
+
+	for (int k = 0; k < 64; k += 4)
+	{
+		const __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + k));
+		const __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(bits, nibbles));
+		const __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(bits, 4), nibbles));
+		counts = _mm256_add_epi64(counts, _mm256_sad_epu8(_mm256_add_epi8(low, high), zero));
+	}
+
+	const __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+	return int(_mm_cvtsi128_si64(halves) + _mm_extract_epi64(halves, 1));
+}
+
+/* -------------------------------------------------------------------------- */
+
+uint64_t atmost(const int values[64], int threshold)
+{
+	uint64_t atmost = 0;
+
+	const __m256i limit = _mm256_set1_epi32(threshold);
+
+	for (int k = 0; k < 64; k += 8)
+	{
+		const __m256i above = _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + k)), limit);
+		atmost |= uint64_t(~_mm256_movemask_ps(_mm256_castsi256_ps(above)) & 0xFF) << k;
+	}
+
+	return atmost;
+}
+
+/* -------------------------------------------------------------------------- */
+
+void minimize(int values[64], const int others[64])
+{
+	for (int k = 0; k < 64; k += 8)
+	{
+		__m256i *destination = reinterpret_cast<__m256i *>(values + k);
+		_mm256_storeu_si256(destination, _mm256_min_epi32(_mm256_loadu_si256(destination), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(others + k))));
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+void maximize(int values[64], const int others[64])
+{
+	for (int k = 0; k < 64; k += 8)
+	{
+		__m256i *destination = reinterpret_cast<__m256i *>(values + k);
+		_mm256_storeu_si256(destination, _mm256_max_epi32(_mm256_loadu_si256(destination), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(others + k))));
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+}}}
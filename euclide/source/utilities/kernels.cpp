@@ -0,0 +1,93 @@
+#include "kernels.h"
+
+namespace Euclide
+{
+namespace Kernels
+{
+
+/* -------------------------------------------------------------------------- */
+
+static bool avx2()
+{
+#if defined(EUCLIDE_LINUX_IMPLEMENTATION)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#elif defined(EUCLIDE_WIN_IMPLEMENTATION)
+	int registers[4];
+
+	/* -- AVX2 requires the operating system to save ymm registers -- */
+
+	__cpuid(registers, 0);
+	if (registers[0] < 7)
+		return false;
+
+	__cpuid(registers, 1);
+	if (!(registers[2] & (1 << 27)) || !(registers[2] & (1 << 28)) || ((_xgetbv(0) & 6) != 6))
+		return false;
+
+	__cpuidex(registers, 7, 0);
+	return (registers[1] & (1 << 5)) ? true : false;
+#else
+	return false;
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+namespace Baseline
+{
+
+static uint64_t merge(const uint64_t words[64], uint64_t selection)
+{
+	uint64_t merged = 0;
+	for (int k = 0; k < 64; k++)
+		if ((selection >> k) & 1)
+			merged |= words[k];
+
+	return merged;
+}
+
+static int count(const uint64_t words[64])
+{
+	int count = 0;
+	for (int k = 0; k < 64; k++)
+		count += intel::popcnt(words[k]);
+
+	return count;
+}
+
+static uint64_t atmost(const int values[64], int threshold)
+{
+	uint64_t atmost = 0;
+	for (int k = 0; k < 64; k++)
+		atmost |= uint64_t(values[k] <= threshold) << k;
+
+	return atmost;
+}
+
+static void minimize(int values[64], const int others[64])
+{
+	xstd::minimize(values, others, 64);
+}
+
+static void maximize(int values[64], const int others[64])
+{
+	xstd::maximize(values, others, 64);
+}
+
+}
+
+/* -------------------------------------------------------------------------- */
+
+static const bool AVX2Processor = avx2();
+
+const Supersets supersets = AVX2Processor ? &AVX2::supersets : &intel::supersets;
+const Merge merge = AVX2Processor ? &AVX2::merge : &Baseline::merge;
+const Count count = AVX2Processor ? &AVX2::count : &Baseline::count;
+const AtMost atmost = AVX2Processor ? &AVX2::atmost : &Baseline::atmost;
+const Reduce minimize = AVX2Processor ? &AVX2::minimize : &Baseline::minimize;
+const Reduce maximize = AVX2Processor ? &AVX2::maximize : &Baseline::maximize;
+
+/* -------------------------------------------------------------------------- */
+
+}}
@@ -0,0 +1,49 @@
+#ifndef __EUCLIDE_KERNELS_H
+#define __EUCLIDE_KERNELS_H
+
+#include "../includes.h"
+
+namespace Euclide
+{
+namespace Kernels
+{
+
+/* -------------------------------------------------------------------------- */
+
+typedef uint64_t (*Supersets)(const uint64_t words[64], uint64_t bits);
+typedef uint64_t (*Merge)(const uint64_t words[64], uint64_t selection);
+typedef int (*Count)(const uint64_t words[64]);
+typedef uint64_t (*AtMost)(const int values[64], int threshold);
+typedef void (*Reduce)(int values[64], const int others[64]);
+
+extern const Supersets supersets;    /**< Words of which bits are a subset, fastest version for the running processor. */
+extern const Merge merge;            /**< Union of the words selected by given bits. */
+extern const Count count;            /**< Number of bits set over all words. */
+extern const AtMost atmost;          /**< Values not greater than threshold. */
+extern const Reduce minimize;        /**< Element-wise minimum of both arrays, stored into the first one. */
+extern const Reduce maximize;        /**< Element-wise maximum of both arrays, stored into the first one. */
+
+/* -------------------------------------------------------------------------- */
+
+static_assert((NumSquares == 64) && (sizeof(Squares) == sizeof(uint64_t)));
+
+static inline const uint64_t *words(const ArrayOfSquares& squares)
+	{ return reinterpret_cast<const uint64_t *>(squares.data()); }
+
+/* -------------------------------------------------------------------------- */
+
+namespace AVX2
+{
+	uint64_t supersets(const uint64_t words[64], uint64_t bits);
+	uint64_t merge(const uint64_t words[64], uint64_t selection);
+	int count(const uint64_t words[64]);
+	uint64_t atmost(const int values[64], int threshold);
+	void minimize(int values[64], const int others[64]);
+	void maximize(int values[64], const int others[64]);
+}
+
+/* -------------------------------------------------------------------------- */
+
+}}
+
+#endif
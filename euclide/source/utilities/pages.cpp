@@ -0,0 +1,134 @@
+#include "pages.h"
+
+#if defined(EUCLIDE_LINUX_IMPLEMENTATION)
+	#include <sys/mman.h>
+	#include <unistd.h>
+	#include <cstdio>
+#elif defined(EUCLIDE_WIN_IMPLEMENTATION)
+	#define NOMINMAX
+	#include <windows.h>
+#endif
+
+namespace Euclide
+{
+
+/* -------------------------------------------------------------------------- */
+
+static inline size_t align(size_t size, size_t alignment)
+{
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/* -------------------------------------------------------------------------- */
+
+#if defined(EUCLIDE_LINUX_IMPLEMENTATION) && defined(MADV_HUGEPAGE)
+static bool transparentHugePages()
+{
+	/* -- Advice is silently ignored when transparent huge pages are disabled system wide -- */
+
+	char modes[64] = "";
+	if (FILE *file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r"))
+	{
+		if (!fgets(modes, sizeof(modes), file))
+			modes[0] = '\0';
+
+		fclose(file);
+	}
+
+	return strstr(modes, "[always]") || strstr(modes, "[madvise]");
+}
+#endif
+
+/* -------------------------------------------------------------------------- */
+
+Pages::Pages(size_t size, bool huge)
+	: m_data(nullptr), m_size(0), m_huge(false)
+{
+#if defined(EUCLIDE_LINUX_IMPLEMENTATION)
+	static const size_t HugePageSize = size_t(2) << 20;
+
+	/* -- Use huge pages set aside by the system, if any -- */
+
+#ifdef MAP_HUGETLB
+	if (huge)
+	{
+		void *data = mmap(nullptr, align(size, HugePageSize), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (data != MAP_FAILED)
+		{
+			m_data = data, m_size = align(size, HugePageSize), m_huge = true;
+			return;
+		}
+	}
+#endif
+
+	/* -- Otherwise map normal pages, aligned so that the kernel may back them with transparent huge pages -- */
+
+	const size_t alignment = huge ? HugePageSize : size_t(sysconf(_SC_PAGESIZE));
+	const size_t slack = huge ? HugePageSize : 0;
+
+	m_size = align(size, alignment);
+
+	char *data = static_cast<char *>(mmap(nullptr, m_size + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+	if (data == MAP_FAILED)
+		throw std::bad_alloc();
+
+	char *aligned = reinterpret_cast<char *>(align(reinterpret_cast<uintptr_t>(data), alignment));
+
+	if (aligned > data)
+		munmap(data, aligned - data);
+	if (data + slack > aligned)
+		munmap(aligned + m_size, data + slack - aligned);
+
+	m_data = aligned;
+
+#ifdef MADV_HUGEPAGE
+	if (huge && (madvise(m_data, m_size, MADV_HUGEPAGE) == 0))
+		m_huge = transparentHugePages();
+#endif
+#elif defined(EUCLIDE_WIN_IMPLEMENTATION)
+	/* -- Large pages require the lock pages in memory privilege, fall back on normal pages without it -- */
+
+	const size_t minimum = huge ? GetLargePageMinimum() : 0;
+
+	if (minimum)
+	{
+		m_data = VirtualAlloc(nullptr, align(size, minimum), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (m_data)
+			m_size = align(size, minimum), m_huge = true;
+	}
+
+	if (!m_data)
+	{
+		m_data = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		m_size = size;
+	}
+
+	if (!m_data)
+		throw std::bad_alloc();
+#else
+	(void)huge;
+
+	m_data = calloc(1, size);
+	m_size = size;
+
+	if (!m_data)
+		throw std::bad_alloc();
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+Pages::~Pages()
+{
+#if defined(EUCLIDE_LINUX_IMPLEMENTATION)
+	munmap(m_data, m_size);
+#elif defined(EUCLIDE_WIN_IMPLEMENTATION)
+	VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+	free(m_data);
+#endif
+}
+
+/* -------------------------------------------------------------------------- */
+
+}
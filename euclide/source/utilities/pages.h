@@ -0,0 +1,42 @@
+#ifndef __EUCLIDE_PAGES_H
+#define __EUCLIDE_PAGES_H
+
+#include "../includes.h"
+
+namespace Euclide
+{
+
+/* -------------------------------------------------------------------------- */
+/* -- Pages                                                                -- */
+/* -------------------------------------------------------------------------- */
+
+class Pages
+{
+	public:
+		Pages(size_t size, bool huge);
+		~Pages();
+
+		template <typename T>
+		inline T *as() const
+			{ return static_cast<T *>(m_data); }
+
+		inline size_t size() const
+			{ return m_size; }
+		inline bool huge() const
+			{ return m_huge; }
+
+	private:
+		Pages(const Pages&) = delete;
+		Pages& operator=(const Pages&) = delete;
+
+	private:
+		void *m_data;     /**< Zero filled memory, directly obtained from the operating system. */
+		size_t m_size;    /**< Size of allocated memory, rounded up to the page size. */
+		bool m_huge;      /**< Set if memory is made of huge pages, or eligible to transparent huge pages, to spare translation lookaside buffer misses. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef __EUCLIDE_THREADS_H
+#define __EUCLIDE_THREADS_H
+
+#include "../includes.h"
+
+namespace Euclide
+{
+
+/* -------------------------------------------------------------------------- */
+/* -- ThreadPool                                                           -- */
+/* -------------------------------------------------------------------------- */
+
+class ThreadPool
+{
+	public:
+		ThreadPool(int threads);
+		~ThreadPool();
+
+		template <typename Function>
+		void run(int tasks, const Function& function);
+
+	private:
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		void work();
+		void execute();
+
+	private:
+		std::vector<std::thread> m_threads;        /**< Worker threads, the calling thread being the last worker. */
+
+		std::mutex m_mutex;                        /**< Protects the batch state below. */
+		std::condition_variable m_start;           /**< Signaled when a new batch of tasks is available. */
+		std::condition_variable m_done;            /**< Signaled when a worker has finished its share of a batch. */
+
+		std::function<void(int)> m_function;       /**< Function run for each task of current batch. */
+		std::atomic<int> m_next;                   /**< Next task to be taken by the first idle worker. */
+		int m_tasks;                               /**< Number of tasks in current batch. */
+		int m_active;                              /**< Number of workers still running current batch. */
+		unsigned m_batch;                          /**< Batch counter, used to wake up workers. */
+		bool m_stop;                               /**< Set when workers shall terminate. */
+
+		std::exception_ptr m_exception;            /**< First exception thrown by a task of current batch. */
+};
+
+/* -------------------------------------------------------------------------- */
+
+inline ThreadPool::ThreadPool(int threads)
+	: m_next(0), m_tasks(0), m_active(0), m_batch(0), m_stop(false)
+{
+	for (int thread = 1; thread < threads; thread++)
+		m_threads.emplace_back(&ThreadPool::work, this);
+}
+
+/* -------------------------------------------------------------------------- */
+
+inline ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_start.notify_all();
+
+	for (std::thread& thread : m_threads)
+		thread.join();
+}
+
+/* -------------------------------------------------------------------------- */
+
+template <typename Function>
+void ThreadPool::run(int tasks, const Function& function)
+{
+	/* -- Small batches are not worth waking up workers -- */
+
+	if (m_threads.empty() || (tasks <= 1))
+	{
+		for (int task = 0; task < tasks; task++)
+			function(task);
+
+		return;
+	}
+
+	/* -- Publish batch, then take our share of the tasks -- */
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_function = std::cref(function);
+		m_next = 0;
+		m_tasks = tasks;
+		m_active = int(m_threads.size());
+		m_exception = nullptr;
+		m_batch += 1;
+	}
+
+	m_start.notify_all();
+	execute();
+
+	/* -- Wait for workers and forward any exception -- */
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [&]() { return m_active == 0; });
+
+	m_function = nullptr;
+
+	if (m_exception)
+		std::rethrow_exception(m_exception);
+}
+
+/* -------------------------------------------------------------------------- */
+
+inline void ThreadPool::work()
+{
+	unsigned batch = 0;
+
+	for ( ; ; )
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_start.wait(lock, [&]() { return m_stop || (m_batch != batch); });
+
+			if (m_stop)
+				return;
+
+			batch = m_batch;
+		}
+
+		execute();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_active -= 1;
+		}
+
+		m_done.notify_one();
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+inline void ThreadPool::execute()
+{
+	for (int task = m_next++; task < m_tasks; task = m_next++)
+	{
+		try
+		{
+			m_function(task);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_exception)
+				m_exception = std::current_exception();
+
+			m_next = m_tasks;
+		}
+	}
+}
+
+/* -------------------------------------------------------------------------- */
+
+}
+
+#endif